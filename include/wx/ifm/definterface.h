@@ -19,12 +19,17 @@
 #include "wx/bitmap.h"
 #include "wx/pen.h"
 #include "wx/brush.h"
+#include "wx/dcmemory.h"
+#include "wx/timer.h"
 
 //#include <list>
 //#include <vector>
 
 #define IFM_FLOATING_FRAME_STYLE wxFRAME_NO_TASKBAR | wxFRAME_FLOAT_ON_PARENT | wxRESIZE_BORDER | wxSYSTEM_MENU | wxCLOSE_BOX
 
+#define IFM_FLOATING_FRAME_POOL_SIZE 2 //!< default number of hidden floating frames kept for reuse
+#define IFM_FLOATING_FRAME_POOL_DELAY 250 //!< milliseconds after a pooled frame is used before the pool is refilled
+
 #define IFM_CAPTION_PAD 1 //!< gap between the caption and the components client area
 
 #define IFM_COMPONENT_BUTTON_X    10
@@ -38,12 +43,19 @@
 
 #define IFM_CONTAINER_GRIPPER_WIDTH 0
 
+#define IFM_HINT_OUTLINE_WIDTH  3 //!< border width of outlined hint windows
+#define IFM_HINT_ALPHA          128 //!< opacity of hint windows where translucency is supported
+
+#define IFM_LAYOUT_VERSION      1 //!< version of the layouts written by SaveLayout, others are rejected
+#define IFM_LAYOUT_MAX_DEPTH    32 //!< deepest component nesting accepted when loading a layout
+
 class wxIFMDefaultInterfacePlugin;
 class wxIFMFloatingFrame;
 class wxIFMDefaultContainerPlugin;
 class wxIFMDefaultPanelPlugin;
 class wxIFMContainerData;
 class wxIFMPanelTabData;
+class wxIFMPanelData;
 class wxIFMAddTopContainerEvent;
 class wxIFMRemoveTopContainerEvent;
 class wxIFMSelectTabEvent;
@@ -59,6 +71,14 @@ WX_DECLARE_LIST(wxIFMComponent, wxIFMComponentList);
 WX_DEFINE_ARRAY(wxIFMComponentButton *, wxIFMComponentButtonArray);
 WX_DEFINE_ARRAY(wxIFMTab *, wxIFMTabArray);
 
+WX_DECLARE_STRING_HASH_MAP(wxSize, wxIFMTextExtentMap);
+class wxIFMTextExtentFont;
+WX_DEFINE_ARRAY(wxIFMTextExtentFont *, wxIFMTextExtentFontArray);
+
+#if IFM_CANFLOAT
+WX_DEFINE_ARRAY(wxFrame *, wxIFMFramePool);
+#endif
+
 // component data keys
 DECLARE_IFM_DATA_KEY(IFM_CONTAINER_DATA_KEY)
 DECLARE_IFM_DATA_KEY(IFM_PANEL_DATA_KEY)
@@ -96,6 +116,11 @@ public:
         const wxSize& size = wxDefaultSize, long style = wxDEFAULT_FRAME_STYLE,
         const wxString& name = wxFrameNameStr);
 
+    /*!
+        Creates a floating frame around an existing, hidden frame.
+    */
+    wxIFMFloatingFrame(wxIFMInterfacePluginBase *ip, wxFrame *frame);
+
     ~wxIFMFloatingFrame() {}
 
     void OnClose(wxCloseEvent &event);
@@ -120,11 +145,41 @@ public:
     */
     bool Initialize(wxInterfaceManager *manager);
 
+    /*!
+        Destroys pooled floating frames and removes extension plugins
+    */
+    void Shutdown();
+
+#if IFM_CANFLOAT
+    /*!
+        Sets how many hidden floating frames are kept ready for new floating windows.
+        Frames of floating windows that are destroyed are returned to the pool until
+        it is full, and frames handed out are replaced shortly after the window floats.
+        A size of 0 disables pooling.
+    */
+    void SetFloatingFramePoolSize(int size);
+    int GetFloatingFramePoolSize() const;
+#endif
+
     /*!
         \return Const reference to the top level container list
+
+        \note The list is rebuilt from GetTopContainers() when the containers changed since
+            the last call. Prefer GetTopContainers().
     */
     const wxIFMComponentList &GetTopContainerList() const;
 
+    /*!
+        \return Const reference to the top level containers, in layout order
+    */
+    const wxIFMComponentArray &GetTopContainers() const;
+
+    /*!
+        \return Index of the given container within GetTopContainers(), or -1 if it is not
+            a top level container
+    */
+    int GetTopContainerIndex(wxIFMComponent *container) const;
+
     bool ProcessPluginEvent(wxIFMPluginEvent &event);
 
     /*!
@@ -135,12 +190,55 @@ public:
 
     wxIFMComponent *GetComponentByPos(const wxPoint &pos, wxIFMComponent *component = NULL, bool floating = false);
 
+    /*!
+        Marks the display lists of the managed window and all floating windows as out of date
+    */
+    void InvalidateDisplayLists();
+
+    /*!
+        Starts a batch of changes, such as adding many children. Until the matching
+        EndBulkUpdate, extension plugins defer work that the next update redoes anyway.
+        Calls may be nested.
+    */
+    void BeginBulkUpdate();
+    void EndBulkUpdate();
+
+    /*!
+        \return True between BeginBulkUpdate and EndBulkUpdate
+    */
+    bool InBulkUpdate() const;
+
 private:
 
-    wxIFMComponentList m_containers;
+    int m_bulkUpdate; //!< nesting level of BeginBulkUpdate calls
+
+    wxIFMComponentArray m_topContainers; //!< top level containers in layout order
+    mutable wxIFMComponentList m_containers; //!< list copy of m_topContainers for GetTopContainerList
+    mutable bool m_containerListDirty;
+
+    /*!
+        Stores the array index of each top level container starting at the given index
+    */
+    void UpdateTopContainerIndices(int start);
+    void RemoveTopContainer(int index);
+
+    wxIFMDisplayList m_displayList; //!< recorded interface, used with IFM_DISPLAY_LIST
+    bool m_displayListDirty; //!< true if the layout changed since m_displayList was built
+
+#if IFM_CANFLOAT
+    wxIFMFramePool m_framePool; //!< hidden frames waiting to be used by a floating window
+    int m_framePoolSize;
+    wxTimer m_framePoolTimer; //!< refills the pool once floating has finished
+
+    void FillFramePool();
+    void TrimFramePool(int size);
+#endif
 
     void OnDeleteComponent(wxIFMDeleteComponentEvent &event);
     void OnAddChild(wxIFMAddChildEvent &event);
+    void OnAddChildren(wxIFMAddChildrenEvent &event);
+    void OnSaveLayout(wxIFMLayoutEvent &event);
+    void OnLoadLayout(wxIFMLayoutEvent &event);
     void OnUpdate(wxIFMUpdateEvent &event);
     void OnPaint(wxIFMPaintInterfaceEvent &event);
     void OnGetContentRect(wxIFMRectEvent &event);
@@ -152,6 +250,7 @@ private:
     void OnCreateFloatingWindow(wxIFMCreateFloatingWindowEvent &event);
     void OnDestroyFloatingWindow(wxIFMDestroyFloatingWindowEvent &event);
     void OnFloat(wxIFMFloatEvent &event);
+    void OnFramePoolTimer(wxTimerEvent &event);
 #endif
 
     DECLARE_EVENT_TABLE()
@@ -191,6 +290,7 @@ private:
     void OnGetRect(wxIFMRectEvent &event);
 
     void OnPaintDecor(wxIFMPaintEvent &event);
+    void OnBuildDisplayList(wxIFMDisplayListEvent &event);
 
     void OnComponentButtonClick(wxIFMComponentButtonEvent &event);
 
@@ -224,6 +324,47 @@ private:
     DECLARE_DYNAMIC_CLASS_NO_COPY(wxIFMDefaultContainerPlugin)
 };
 
+/*!
+    Extents of all strings measured with one font
+*/
+class wxIFMTextExtentFont
+{
+public:
+    wxFont m_font;
+    wxIFMTextExtentMap m_extents;
+};
+
+/*!
+    Cache of text extents keyed by font and string. Shared by the tab and caption
+    code so that labels are only measured once per font instead of on every update.
+*/
+class wxIFMTextExtentCache
+{
+public:
+    ~wxIFMTextExtentCache();
+
+    /*!
+        \return The extent of \a text drawn with \a font, measuring it only if it
+            is not cached yet.
+
+        \param window Window to measure with. If NULL, a memory dc is used.
+    */
+    wxSize GetTextExtent(const wxString &text, const wxFont &font, wxWindow *window = NULL);
+
+    /*!
+        Discards all extents measured with the given font
+    */
+    void Remove(const wxFont &font);
+
+    /*!
+        Discards all cached extents
+    */
+    void Clear();
+
+private:
+    wxIFMTextExtentFontArray m_fonts;
+};
+
 /*!
     Configuration data for tab appearance
 */
@@ -465,10 +606,17 @@ public:
     */
     static wxIFMTabConfig &GetTabConfig();
 
+    /*!
+        Returns a reference to the text extent cache used to measure tab and
+        caption labels.
+    */
+    static wxIFMTextExtentCache &GetTextExtentCache();
+
 private:
 
     static wxIFMCaptionConfig m_caption_config;
     static wxIFMTabConfig m_tab_config;
+    static wxIFMTextExtentCache m_text_extents;
     static bool init_config;
 
     void OnCreateComponent(wxIFMNewComponentEvent &event);
@@ -479,6 +627,7 @@ private:
     void OnShowComponent(wxIFMShowComponentEvent &event);
     void OnPaintDecor(wxIFMPaintEvent &event);
     void OnPaintBg(wxIFMPaintEvent &event);
+    void OnBuildDisplayList(wxIFMDisplayListEvent &event);
     void OnLeftDown(wxIFMMouseEvent &event);
     void OnLeftUp(wxIFMMouseEvent &event);
     void OnMouseMove(wxIFMMouseEvent &event);
@@ -505,6 +654,11 @@ private:
     */
 	void DrawCaption(wxDC &dc, const wxRect &rect, const wxString &caption, int orientation);
 
+    /*!
+        Records a caption into a display list. Produces the same output as DrawCaption.
+    */
+    void RecordCaption(wxIFMDisplayList &list, const wxRect &rect, const wxString &caption, int orientation);
+
     /*!
         Updates the sizes for the tabs of this component. If
         the component is not actually a panel, this function does nothing.
@@ -523,6 +677,16 @@ private:
     */
     void DrawTabs(wxDC &dc, wxIFMComponent *component, const wxRegion &region, const wxIFMTabArray &tabs);
 
+    /*!
+        \return The area occupied by the tab row of the given panel
+    */
+    wxRect GetTabRowRect(wxIFMComponent *panel);
+
+    /*!
+        Renders the tab row of the given panel into its tab cache if the cache is out of date
+    */
+    void UpdateTabsCache(wxIFMComponent *panel, wxIFMPanelData *data);
+
     /*!
         Returns true if the tab row should be displayed for the given tabs
     */
@@ -668,6 +832,54 @@ public:
     DECLARE_EVENT_TABLE()
 };
 
+/*!
+    Popup window used to display resize and docking hints.
+
+    The window is created once and moved around while the user drags, instead
+    of XOR painting onto the screen. Callers show the hint from motion that is
+    already coalesced by wxIFMMotionScheduler, so moves are applied immediately.
+*/
+class WXDLLIMPEXP_IFM wxIFMHintWindow : public wxFrame
+{
+private:
+
+    wxRect m_rect;
+    bool m_outline, m_shaped;
+    wxBitmap m_bitmap;
+
+public:
+
+    wxIFMHintWindow(wxWindow *parent);
+
+    /*!
+        Shows the hint window over the given rect, or moves it there if it is already visible.
+
+        \param rect Hint rect in screen coordinates
+        \param outline If true, only a border around the rect is shown
+    */
+    void ShowHint(const wxRect &rect, bool outline = false);
+
+    /*!
+        Hides the hint window.
+    */
+    void HideHint();
+
+    /*!
+        Sets a bitmap to paint instead of the plain hint colour. Pass wxNullBitmap
+        to go back to the plain hint.
+    */
+    void SetBitmap(const wxBitmap &bitmap);
+
+private:
+
+    void MoveHint(const wxRect &rect);
+
+    void OnEraseBackground(wxEraseEvent &event);
+    void OnPaint(wxPaintEvent &event);
+
+    DECLARE_EVENT_TABLE()
+};
+
 /*!
     Data storage for AddChild data for wxIFMDefaultInterfacePlugin
 */
@@ -754,6 +966,7 @@ public:
     //wxIFMComponentButtonManager m_buttonManager;
 
     int m_orientation; //!< where is this container? (top, bottom, left, right, docked)
+    int m_index; //!< position in the top level container array, -1 if not a top level container
     wxRect m_tray_rect; //!< area containing buttons and extras for the container. Also the drag enabled area
 
     wxIFMComponentDataKeyType GetDataKey() const;
@@ -798,6 +1011,65 @@ public:
     int m_name_width; //!< Width of the components name string
 };
 
+/*!
+    Retained rendering of a piece of component decoration, such as a caption or
+    a tab row. Used when the interface manager has the IFM_RETAINED_DECORATIONS flag.
+
+    The cached bitmap covers m_rect, which is stored in the same coordinates used
+    for painting the component.
+*/
+class WXDLLIMPEXP_IFM wxIFMDecorationCache
+{
+public:
+    wxIFMDecorationCache()
+        : m_valid(false)
+    { }
+
+    /*!
+        \return True if the cache holds a rendering of the given rect
+    */
+    bool IsValid(const wxRect &rect) const { return m_valid && m_rect == rect; }
+
+    /*!
+        Discards the cached rendering. The next paint will render it again.
+    */
+    void Invalidate() { m_valid = false; }
+
+    /*!
+        Prepares the given memory dc for rendering the decoration. The dc uses the
+        same coordinates as the component, so the normal drawing code can be used as is.
+        The bitmap is only reallocated if the size of the rect has changed.
+
+        \return False if the rect is empty, in which case nothing should be rendered
+    */
+    bool BeginRender(wxMemoryDC &dc, const wxRect &rect);
+
+    /*!
+        Finishes rendering started with BeginRender and marks the cache as valid.
+    */
+    void EndRender(wxMemoryDC &dc);
+
+    /*!
+        Blits the portions of the cached rendering that intersect the given region.
+    */
+    void Blit(wxDC &dc, const wxRegion &region);
+
+    /*!
+        \return The cached rendering
+    */
+    const wxBitmap &GetBitmap() const { return m_bitmap; }
+
+    /*!
+        \return The rect covered by the cached rendering
+    */
+    const wxRect &GetRect() const { return m_rect; }
+
+private:
+    wxBitmap m_bitmap;
+    wxRect m_rect;
+    bool m_valid;
+};
+
 /*!
     Storage class for data specific to "tabbed panels"
 */
@@ -828,6 +1100,14 @@ public:
 
     wxIFMTabArray m_tabs;
 
+    wxIFMDecorationCache m_caption_cache; //!< retained rendering of the caption
+    wxIFMDecorationCache m_tabs_cache; //!< retained rendering of the tab row
+
+    /*!
+        Discards the retained renderings of the caption and tab row
+    */
+    void InvalidateDecorations();
+
     wxIFMComponentDataKeyType GetDataKey() const;
     static wxIFMComponentDataKeyType DataKey();
 
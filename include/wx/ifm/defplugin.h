@@ -46,6 +46,7 @@ private:
     void OnEndPaint(wxIFMEndPaintEvent &event);
     void OnPaintBg(wxIFMPaintEvent &event); //!< handles PaintBG
     void OnPaintBorder(wxIFMPaintEvent &event);
+    void OnBuildDisplayList(wxIFMDisplayListEvent &event); //!< records backgrounds and borders
     void OnGetDesiredSize(wxIFMRectEvent &event);
     void OnSetDesiredSize(wxIFMRectEvent &event);
     void OnSetMinSize(wxIFMRectEvent &event);
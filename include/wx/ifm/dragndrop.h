@@ -15,7 +15,6 @@
 #include "wx/ifm/definterface.h"
 
 #include "wx/frame.h"
-#include "wx/dcscreen.h"
 //#include <vector>
 
 class wxIFMDefaultDockingPlugin;
@@ -76,12 +75,28 @@ private:
     int m_dragx, m_dragy;
 
     wxRect m_hintRect;
+    wxIFMHintWindow *m_hint; //!< created the first time a dock hint is shown
 
-    DockButtonArray m_dockButtonArray;
+    wxIFMMotionScheduler m_motion;
+
+    DockButtonArray m_dockButtonArray; //!< created on the first drag and reused until shutdown
     wxIFMDockTargetButton *m_oldBtn;
+    bool m_frameButtonsShown, m_componentButtonsShown;
+
+    // layout the drop target buttons were last positioned for
+    bool m_targetValid;
+    wxIFMComponentHandle m_targetComponent;
+    wxPoint m_targetPos;
+    wxRect m_targetInterfaceRect;
 
 #if IFM_CANFLOAT
     wxIFMFloatingWindowBase *m_window;
+
+    bool m_ghosting; //!< true while dragging a snapshot of a docked component
+    wxRect m_ghostRect; //!< screen rect of the snapshot
+    wxIFMHintWindow *m_ghost; //!< created the first time a ghost drag begins
+
+    wxIFMComponentHandle m_emptyContainer; //!< container a drag started from, removed at drag end if still empty
 #endif
 
 public:
@@ -89,6 +104,7 @@ public:
     wxIFMDefaultDockingPlugin();
 
     bool Initialize(wxIFMInterfacePluginBase *plugin);
+    void Shutdown();
 
 private:
 
@@ -106,11 +122,42 @@ private:
     void OnDock(wxIFMDockEvent &event);
     void OnShowDropTargets(wxIFMShowDropTargetsEvent &event);
 
-    void DrawHintRect(wxDC &dc, const wxRect &rect);
+    /*!
+        Outlines the area the dragged component will occupy if it is dropped on the given button.
+        Passing NULL hides the hint.
+    */
+    void ShowHintRect(wxIFMDockTargetButton *btn);
+
+#if IFM_CANFLOAT
+    /*!
+        Takes a snapshot of the given docked component and starts dragging it instead of
+        floating the component.
+
+        \param pos Mouse position in screen coordinates
+        \return false if the component has nothing to take a snapshot of
+    */
+    bool BeginGhostDrag(wxIFMComponent *component, const wxPoint &pos);
+    void EndGhostDrag();
+
+    /*!
+        Deletes the container the last drag started from if it still exists and has no
+        children left, and updates the floating window it was in.
+    */
+    void RemoveEmptyContainer();
+#endif
 
+    /*!
+        Creates the dock target buttons the first time it is called, and moves the frame
+        buttons to the edges of the current interface rect.
+    */
     void CreateTargetButtons();
     void DestroyTargetButtons();
 
+    /*!
+        Hides all dock target buttons without destroying them so the next drag can reuse them.
+    */
+    void HideTargetButtons();
+
     void ShowFrameDropButtons(bool show = true);
     void ShowComponentDropButtons(bool show  = true);
 
@@ -48,8 +48,11 @@ DECLARE_EXPORTED_EVENT_TYPE(WXDLLIMPEXP_IFM, wxEVT_IFM_DELETECOMPONENT, 0) // us
 DECLARE_EXPORTED_EVENT_TYPE(WXDLLIMPEXP_IFM, wxEVT_IFM_SHOWCOMPONENT, 0) // used to show or hide components
 DECLARE_EXPORTED_EVENT_TYPE(WXDLLIMPEXP_IFM, wxEVT_IFM_VISIBILITYCHANGED, 0) // used to notify a component that is has been shown or hidden
 DECLARE_EXPORTED_EVENT_TYPE(WXDLLIMPEXP_IFM, wxEVT_IFM_ADDCHILD, 0) // add a child window to the interface
+DECLARE_EXPORTED_EVENT_TYPE(WXDLLIMPEXP_IFM, wxEVT_IFM_ADDCHILDREN, 0) // add several child windows to the interface at once
 DECLARE_EXPORTED_EVENT_TYPE(WXDLLIMPEXP_IFM, wxEVT_IFM_SETCHILD, 0) // used to add children to panels
 DECLARE_EXPORTED_EVENT_TYPE(WXDLLIMPEXP_IFM, wxEVT_IFM_REMOVECHILD, 0) // removes a child from its panel (and the interface)
+DECLARE_EXPORTED_EVENT_TYPE(WXDLLIMPEXP_IFM, wxEVT_IFM_SAVELAYOUT, 0) // stores the arrangement of the interface in a string
+DECLARE_EXPORTED_EVENT_TYPE(WXDLLIMPEXP_IFM, wxEVT_IFM_LOADLAYOUT, 0) // restores an arrangement stored by wxEVT_IFM_SAVELAYOUT
 
 DECLARE_EXPORTED_EVENT_TYPE(WXDLLIMPEXP_IFM, wxEVT_IFM_PAINTINTERFACE, 0) // indicates to plugins that some or all of the interface needs to be repainted
 DECLARE_EXPORTED_EVENT_TYPE(WXDLLIMPEXP_IFM, wxEVT_IFM_PAINTBG, 0) // paints a components background
@@ -57,6 +60,7 @@ DECLARE_EXPORTED_EVENT_TYPE(WXDLLIMPEXP_IFM, wxEVT_IFM_PAINTBORDER, 0) // paints
 DECLARE_EXPORTED_EVENT_TYPE(WXDLLIMPEXP_IFM, wxEVT_IFM_PAINTDECOR, 0) // paints a components decorations
 DECLARE_EXPORTED_EVENT_TYPE(WXDLLIMPEXP_IFM, wxEVT_IFM_BEGINPAINT, 0)
 DECLARE_EXPORTED_EVENT_TYPE(WXDLLIMPEXP_IFM, wxEVT_IFM_ENDPAINT, 0)
+DECLARE_EXPORTED_EVENT_TYPE(WXDLLIMPEXP_IFM, wxEVT_IFM_BUILDDISPLAYLIST, 0) // records a components background, border, or decorations into a display list
 
 DECLARE_EXPORTED_EVENT_TYPE(WXDLLIMPEXP_IFM, wxEVT_IFM_SHOW, 0) // called to show or hide panels
 DECLARE_EXPORTED_EVENT_TYPE(WXDLLIMPEXP_IFM, wxEVT_IFM_SHOWCHILD, 0) // used to show children managed by the interface
@@ -322,6 +326,87 @@ public:
     bool GetSuccess() const { return m_success; }
 };
 
+/*!
+    \brief Event used to add several child windows at once.
+
+    Interface plugins that don't handle this event are sent a wxIFMAddChildEvent
+    for each child instead.
+*/
+class WXDLLIMPEXP_IFM wxIFMAddChildrenEvent : public wxIFMPluginEvent
+{
+protected:
+    const wxIFMChildDataArray *m_children; //!< data about the child windows
+    int m_added; //!< number of children added successfully
+
+public:
+
+    wxIFMAddChildrenEvent(const wxIFMChildDataArray &children)
+        : wxIFMPluginEvent(wxEVT_IFM_ADDCHILDREN),
+        m_children(&children),
+        m_added(0)
+    { }
+
+    wxIFMAddChildrenEvent(const wxIFMAddChildrenEvent &event)
+        : wxIFMPluginEvent(event),
+        m_children(event.m_children),
+        m_added(event.m_added)
+    { }
+
+    virtual wxEvent *Clone() const { return new wxIFMAddChildrenEvent(*this); }
+
+    /*!
+        \return Data about the children being added by this event
+    */
+    const wxIFMChildDataArray &GetChildren() const { return *m_children; }
+
+    /*!
+        Specifies how many of the children were added successfully
+    */
+    void SetAddedCount(int count) { m_added = count; }
+    int GetAddedCount() const { return m_added; }
+};
+
+/*!
+    \brief Used to save and restore the arrangement of the interface.
+
+    wxEVT_IFM_SAVELAYOUT handlers store the layout in the event, wxEVT_IFM_LOADLAYOUT
+    handlers rebuild the interface from the layout given to the event.
+*/
+class WXDLLIMPEXP_IFM wxIFMLayoutEvent : public wxIFMPluginEvent
+{
+protected:
+    wxString m_layout;
+    bool m_success;
+
+public:
+
+    wxIFMLayoutEvent(wxEventType type, const wxString &layout = wxEmptyString)
+        : wxIFMPluginEvent(type),
+        m_layout(layout),
+        m_success(false)
+    { }
+
+    wxIFMLayoutEvent(const wxIFMLayoutEvent &event)
+        : wxIFMPluginEvent(event),
+        m_layout(event.m_layout),
+        m_success(event.m_success)
+    { }
+
+    virtual wxEvent *Clone() const { return new wxIFMLayoutEvent(*this); }
+
+    /*!
+        \return The saved layout
+    */
+    const wxString &GetLayout() const { return m_layout; }
+    void SetLayout(const wxString &layout) { m_layout = layout; }
+
+    /*!
+        Specifies if the layout was saved or loaded successfully
+    */
+    void SetSuccess(bool s = true) { m_success = s; }
+    bool GetSuccess() const { return m_success; }
+};
+
 /*!
     \brief Event to dock a component into another component.
 
@@ -863,21 +948,24 @@ protected:
     wxDC *m_dc; //!< dc to use to paint
     bool m_onpaint; //!< true if this event is being sent as the result of a wxEVT_PAINT message
     wxWindow *m_window; //!< window on which to paint
+    wxBitmap *m_buffer; //!< persistent back buffer owned by the window being painted, may be NULL
 
 public:
 
-    wxIFMBeginPaintEvent(wxWindow *window, bool onpaint = true)
+    wxIFMBeginPaintEvent(wxWindow *window, bool onpaint = true, wxBitmap *buffer = NULL)
         : wxIFMPluginEvent(wxEVT_IFM_BEGINPAINT),
         m_dc(NULL),
         m_onpaint(onpaint),
-        m_window(window)
+        m_window(window),
+        m_buffer(buffer)
     { }
 
     wxIFMBeginPaintEvent(const wxIFMBeginPaintEvent& event)
         : wxIFMPluginEvent(event),
         m_dc(event.m_dc),
         m_onpaint(event.m_onpaint),
-        m_window(event.m_window)
+        m_window(event.m_window),
+        m_buffer(event.m_buffer)
     { }
 
     virtual wxEvent *Clone() const { return new wxIFMBeginPaintEvent(*this); }
@@ -901,6 +989,13 @@ public:
         Returns the window on which to paint
     */
     wxWindow *GetWindow() const { return m_window; }
+
+    /*!
+        Returns the back buffer kept by the window being painted, or NULL if there
+        is none. Handlers creating a buffered DC should use it (growing it if needed)
+        instead of allocating a new buffer for every paint.
+    */
+    wxBitmap *GetBuffer() const { return m_buffer; }
 };
 
 /*!
@@ -933,6 +1028,53 @@ public:
     wxDC *GetDC() const { return m_dc; }
 };
 
+#define IFM_DISPLAY_BACKGROUND  1 //!< record the background of a component
+#define IFM_DISPLAY_BORDER      2 //!< record the border of a component
+#define IFM_DISPLAY_DECORATIONS 3 //!< record the decorations of a component
+
+/*!
+    \brief Event used to record a component into a display list.
+
+    This is the display list counterpart of wxIFMPaintEvent. It is sent once for each
+    phase (background, border, decorations) of every visible component after layout when
+    the IFM_DISPLAY_LIST flag is used. Handlers should add the primitives they would
+    otherwise paint to the display list instead of painting them.
+
+    \see wxIFMDisplayList, wxIFMComponent::BuildDisplayList
+*/
+class WXDLLIMPEXP_IFM wxIFMDisplayListEvent : public wxIFMPluginEvent
+{
+protected:
+    wxIFMDisplayList &m_list; //!< display list to add primitives to
+    int m_phase; //!< what is being recorded
+
+public:
+
+    wxIFMDisplayListEvent(wxIFMComponent *component, wxIFMDisplayList &list, int phase)
+        : wxIFMPluginEvent(wxEVT_IFM_BUILDDISPLAYLIST, component),
+        m_list(list),
+        m_phase(phase)
+    { }
+
+    wxIFMDisplayListEvent(const wxIFMDisplayListEvent& event)
+        : wxIFMPluginEvent(event),
+        m_list(event.m_list),
+        m_phase(event.m_phase)
+    { }
+
+    virtual wxEvent *Clone() const { return new wxIFMDisplayListEvent(*this); }
+
+    /*!
+        \return Reference to the display list to add primitives to
+    */
+    wxIFMDisplayList &GetDisplayList() const { return m_list; }
+
+    /*!
+        \return IFM_DISPLAY_BACKGROUND, IFM_DISPLAY_BORDER, or IFM_DISPLAY_DECORATIONS
+    */
+    int GetPhase() const { return m_phase; }
+};
+
 /*!
     \brief Event for keyboard input messages.
 
@@ -1666,7 +1808,9 @@ public:
 typedef void (wxEvtHandler::*wxIFMNewComponentEventFunction)(wxIFMNewComponentEvent&);
 typedef void (wxEvtHandler::*wxIFMDeleteComponentEventFunction)(wxIFMDeleteComponentEvent&);
 typedef void (wxEvtHandler::*wxIFMAddChildEventFunction)(wxIFMAddChildEvent&);
+typedef void (wxEvtHandler::*wxIFMAddChildrenEventFunction)(wxIFMAddChildrenEvent&);
 typedef void (wxEvtHandler::*wxIFMSetChildEventFunction)(wxIFMSetChildEvent&);
+typedef void (wxEvtHandler::*wxIFMLayoutEventFunction)(wxIFMLayoutEvent&);
 
 /*
 typedef void (wxEvtHandler::*wxIFMInitializeEventFunction)(wxIFMInitializeEvent&);
@@ -1697,6 +1841,7 @@ typedef void (wxEvtHandler::*wxIFMPaintInterfaceEventFunction)(wxIFMPaintInterfa
 typedef void (wxEvtHandler::*wxIFMPaintEventFunction)(wxIFMPaintEvent&);
 typedef void (wxEvtHandler::*wxIFMBeginPaintEventFunction)(wxIFMBeginPaintEvent&);
 typedef void (wxEvtHandler::*wxIFMEndPaintEventFunction)(wxIFMEndPaintEvent&);
+typedef void (wxEvtHandler::*wxIFMDisplayListEventFunction)(wxIFMDisplayListEvent&);
 
 typedef void (wxEvtHandler::*wxIFMKeyEventFunction)(wxIFMKeyEvent&);
 typedef void (wxEvtHandler::*wxIFMMouseEventFunction)(wxIFMMouseEvent&);
@@ -1719,8 +1864,12 @@ typedef void (wxEvtHandler::*wxIFMDestroyFloatingWindowEventFunction)(wxIFMDestr
     (wxObjectEventFunction)wxStaticCastEvent(wxIFMDeleteComponentEventFunction, &func)
 #define wxIFMAddChildEventFunctionHandler(func) \
     (wxObjectEventFunction)wxStaticCastEvent(wxIFMAddChildEventFunction, &func)
+#define wxIFMAddChildrenEventFunctionHandler(func) \
+    (wxObjectEventFunction)wxStaticCastEvent(wxIFMAddChildrenEventFunction, &func)
 #define wxIFMSetChildEventFunctionHandler(func) \
     (wxObjectEventFunction)wxStaticCastEvent(wxIFMSetChildEventFunction, &func)
+#define wxIFMLayoutEventFunctionHandler(func) \
+    (wxObjectEventFunction)wxStaticCastEvent(wxIFMLayoutEventFunction, &func)
 /*
 #define wxIFMInitializeEventFunctionHandler(func) \
     (wxObjectEventFunction)wxStaticCastEvent(wxIFMInitializeEventFunction, &func)
@@ -1770,6 +1919,8 @@ typedef void (wxEvtHandler::*wxIFMDestroyFloatingWindowEventFunction)(wxIFMDestr
     (wxObjectEventFunction)wxStaticCastEvent(wxIFMBeginPaintEventFunction, &func)
 #define wxIFMEndPaintEventFunctionHandler(func) \
     (wxObjectEventFunction)wxStaticCastEvent(wxIFMEndPaintEventFunction, &func)
+#define wxIFMDisplayListEventFunctionHandler(func) \
+    (wxObjectEventFunction)wxStaticCastEvent(wxIFMDisplayListEventFunction, &func)
 
 #define wxIFMKeyEventFunctionHandler(func) \
     (wxObjectEventFunction)wxStaticCastEvent(wxIFMKeyEventFunction, &func)
@@ -1800,7 +1951,10 @@ typedef void (wxEvtHandler::*wxIFMDestroyFloatingWindowEventFunction)(wxIFMDestr
 #define EVT_IFM_NEWCOMPONENT(func)  wx__DECLARE_EVT0( wxEVT_IFM_NEWCOMPONENT, wxIFMNewComponentEventFunctionHandler(func))
 #define EVT_IFM_DELETECOMPONENT(func) wx__DECLARE_EVT0( wxEVT_IFM_DELETECOMPONENT, wxIFMDeleteComponentEventFunctionHandler(func))
 #define EVT_IFM_ADDCHILD(func)      wx__DECLARE_EVT0( wxEVT_IFM_ADDCHILD, wxIFMAddChildEventFunctionHandler(func))
+#define EVT_IFM_ADDCHILDREN(func)   wx__DECLARE_EVT0( wxEVT_IFM_ADDCHILDREN, wxIFMAddChildrenEventFunctionHandler(func))
 #define EVT_IFM_SETCHILD(func)      wx__DECLARE_EVT0( wxEVT_IFM_SETCHILD, wxIFMSetChildEventFunctionHandler(func))
+#define EVT_IFM_SAVELAYOUT(func)    wx__DECLARE_EVT0( wxEVT_IFM_SAVELAYOUT, wxIFMLayoutEventFunctionHandler(func))
+#define EVT_IFM_LOADLAYOUT(func)    wx__DECLARE_EVT0( wxEVT_IFM_LOADLAYOUT, wxIFMLayoutEventFunctionHandler(func))
 
 #define EVT_IFM_DOCK(func)          wx__DECLARE_EVT0( wxEVT_IFM_DOCK, wxIFMDockEventFunctionHandler(func))
 #define EVT_IFM_UNDOCK(func)        wx__DECLARE_EVT0( wxEVT_IFM_UNDOCK, wxIFMUndockEventFunctionHandler(func))
@@ -1851,6 +2005,7 @@ background, border, decorations
 #define EVT_IFM_PAINTBG(func)       wx__DECLARE_EVT0( wxEVT_IFM_PAINTBG, wxIFMPaintEventFunctionHandler(func))
 #define EVT_IFM_PAINTBORDER(func)   wx__DECLARE_EVT0( wxEVT_IFM_PAINTBORDER, wxIFMPaintEventFunctionHandler(func))
 #define EVT_IFM_PAINTDECOR(func)    wx__DECLARE_EVT0( wxEVT_IFM_PAINTDECOR, wxIFMPaintEventFunctionHandler(func))
+#define EVT_IFM_BUILDDISPLAYLIST(func) wx__DECLARE_EVT0( wxEVT_IFM_BUILDDISPLAYLIST, wxIFMDisplayListEventFunctionHandler(func))
 
 // input events
 #define EVT_IFM_KEYDOWN(func)       wx__DECLARE_EVT0( wxEVT_IFM_KEYDOWN, wxIFMKeyEventFunctionHandler(func))
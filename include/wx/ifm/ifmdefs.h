@@ -19,6 +19,9 @@
 //! Controls whether or not Panels with tabs are allowed to become tabs within other panels
 #define IFM_ALLOW_NESTED_PANELS 0
 
+//! Allocate components and their extension data from slabs instead of individually
+#define IFM_USE_COMPONENT_SLABS 1
+
 // make cvs integration easier by using standard wxwidgets export methods
 #ifdef WXMAKINGDLL_IFM
 #    define WXDLLIMPEXP_IFM WXEXPORT
@@ -54,6 +57,7 @@ class wxIFMFloatingData;
 class wxIFMComponent;
 class wxIFMChildDataBase;
 class wxIFMFloatingWindowBase;
+class wxIFMDisplayList;
 
 //typedef std::vector<wxIFMInterfacePluginBase *> wxIFMInterfacePluginArray;
 //typedef std::vector<wxIFMComponent *> wxIFMComponentArray;
@@ -61,6 +65,7 @@ class wxIFMFloatingWindowBase;
 WX_DEFINE_ARRAY(wxIFMInterfacePluginBase*, wxIFMInterfacePluginArray);
 WX_DEFINE_ARRAY(wxIFMComponent*, wxIFMComponentArray);
 WX_DEFINE_ARRAY(wxIFMFloatingWindowBase*, wxIFMFloatingWindowArray);
+WX_DEFINE_ARRAY(wxIFMChildDataBase*, wxIFMChildDataArray);
 
 /*
 Data key stuff
@@ -70,6 +75,7 @@ typedef int wxIFMComponentDataKeyType; //!< Data type used to retrieve component
 WX_DECLARE_HASH_MAP(wxIFMComponentDataKeyType, wxIFMExtensionDataBase*, wxIntegerHash, wxIntegerEqual, wxIFMComponentDataMap);
 #define DECLARE_IFM_DATA_KEY(name)  extern const wxIFMComponentDataKeyType name;
 #define DEFINE_IFM_DATA_KEY(name)   const wxIFMComponentDataKeyType name = GetNewDataKey();
+#define IFM_COMPONENT_DATA_SLOTS    8 //!< data with keys below this value is stored inline in each component
 
 /*
 Component type stuff
@@ -83,8 +89,7 @@ Component type stuff
 Child types stuff
 */
 class wxWindow;
-//typedef std::map<const wxWindow*, wxIFMComponent*> wxIFMChildWindowMap;
-WX_DECLARE_HASH_MAP(unsigned int, wxIFMComponent*, wxIntegerHash, wxIntegerEqual, wxIFMChildWindowMap);
+class wxIFMChildWindowMap; // defined in plugin.h
 #define DECLARE_IFM_CHILD_TYPE(name)    extern WXDLLIMPEXP_IFM const int name;
 #define DEFINE_IFM_CHILD_TYPE(name)     const int name = GetNewChildType();
 #define IFM_CHILDTYPE_UNDEFINED 0 // don't know (error!)
@@ -106,6 +111,10 @@ DECLARE_IFM_CHILD_TYPE(IFM_CHILD_TOOLBAR) // defined in manager.cpp
     Various flags
 */
 #define IFM_NO_RESIZE_UPDATE    0x00000001 //!< don't update the interface in response to an EVT_SIZE event
+#define IFM_RETAINED_DECORATIONS 0x00000002 //!< cache rendered component decorations (captions, tabs) between paints
+#define IFM_DISPLAY_LIST        0x00000004 //!< record the interface into a display list after layout and replay it when painting
+#define IFM_LIVE_RESIZE         0x00000008 //!< relayout while a resize sash is being dragged instead of drawing a hint
+#define IFM_GHOST_DRAG          0x00000010 //!< drag a snapshot of docked components and only float them when dropped
 #define IFM_DEFAULT_FLAGS       0
 
 #define IFM_DISABLE_STATUS_MESSAGES -1 //!< used to disable the display of status messages in the frames status bar
@@ -15,6 +15,10 @@
 
 #include "wx/window.h"
 #include "wx/statusbr.h"
+#include "wx/pen.h"
+#include "wx/brush.h"
+#include "wx/font.h"
+#include "wx/bitmap.h"
 
 /*!
     \return New unique data key for component data
@@ -33,6 +37,145 @@ WXDLLIMPEXP_IFM int GetNewChildType();
 
 DECLARE_IFM_DATA_KEY(IFM_FLOATING_DATA_KEY)
 
+#define IFM_SLAB_ALIGN          16 //!< slab block sizes are rounded up to a multiple of this
+#define IFM_SLAB_BLOCKS         32 //!< number of blocks allocated at once by a slab allocator
+#define IFM_DATA_SLAB_CLASSES   16 //!< extension data up to IFM_DATA_SLAB_CLASSES * IFM_SLAB_ALIGN bytes uses slabs
+
+/*!
+    \brief Hands out fixed size blocks carved from larger slabs.
+
+    Freed blocks are kept on a free list and handed out again, so objects of the same
+    size end up next to each other in memory. Slabs are only returned to the system
+    by Purge, once every block has been freed.
+*/
+class WXDLLIMPEXP_IFM wxIFMSlabAllocator
+{
+private:
+    size_t m_blockSize;
+    void *m_free; //!< singly linked list of free blocks
+    wxArrayPtrVoid m_slabs;
+    size_t m_used; //!< number of blocks currently handed out
+
+    void AddSlab();
+
+public:
+    wxIFMSlabAllocator(size_t blockSize = 0);
+    ~wxIFMSlabAllocator();
+
+    /*!
+        Sets the size of the blocks handed out. Only valid before the first allocation.
+    */
+    void SetBlockSize(size_t blockSize);
+
+    void *Alloc();
+    void Free(void *block);
+
+    /*!
+        Allocates slabs until at least count blocks can be handed out without allocating.
+    */
+    void Reserve(size_t count);
+
+    /*!
+        Returns all slabs to the system if no blocks are in use.
+    */
+    void Purge();
+};
+
+#define IFM_DRAW_RECT       1 //!< filled rectangle, optionally with rounded corners
+#define IFM_DRAW_LINE       2 //!< single line
+#define IFM_DRAW_TEXT       3 //!< run of text
+#define IFM_DRAW_BITMAP     4 //!< bitmap
+#define IFM_DRAW_GRADIENT   5 //!< rectangle filled with a linear gradient
+
+/*!
+    \brief A single draw primitive stored in a wxIFMDisplayList.
+*/
+class WXDLLIMPEXP_IFM wxIFMDisplayItem
+{
+public:
+    int m_type; //!< type of primitive (IFM_DRAW_*)
+    wxRect m_bounds; //!< area touched by this primitive, used to cull it against the update region
+    wxRect m_rect; //!< rectangle for rects and gradients
+    wxPoint m_pt1, m_pt2; //!< line end points, or the position of text and bitmaps in m_pt1
+    wxPen m_pen;
+    wxBrush m_brush;
+    wxFont m_font;
+    wxColour m_colour1, m_colour2; //!< text colour, or the start and end colours of a gradient
+    wxString m_text;
+    wxBitmap m_bitmap;
+    int m_param; //!< corner radius for rects, direction for gradients, mask usage for bitmaps
+};
+
+WX_DECLARE_EXPORTED_OBJARRAY(wxIFMDisplayItem, wxIFMDisplayItemArray);
+
+/*!
+    \brief Flat list of draw primitives describing how the interface looks.
+
+    When the IFM_DISPLAY_LIST flag is used, the interface plugin builds one of these
+    after layout by sending wxEVT_IFM_BUILDDISPLAYLIST events to each visible component,
+    and replays it on every paint. Plugins contribute primitives by handling that event.
+*/
+class WXDLLIMPEXP_IFM wxIFMDisplayList
+{
+private:
+    wxIFMDisplayItemArray m_items;
+
+    wxIFMDisplayItem &AddItem(int type, const wxRect &bounds);
+
+public:
+
+    /*!
+        Removes all primitives from the list
+    */
+    void Clear();
+
+    /*!
+        \return Number of primitives in the list
+    */
+    size_t GetCount() const { return m_items.GetCount(); }
+
+    /*!
+        Adds a rectangle. If \a radius is not 0, the rectangle has rounded corners.
+    */
+    void AddRectangle(const wxRect &rect, const wxPen &pen, const wxBrush &brush, int radius = 0);
+
+    /*!
+        Adds a line from (x1, y1) to (x2, y2).
+    */
+    void AddLine(int x1, int y1, int x2, int y2, const wxPen &pen);
+
+    /*!
+        Adds a run of text.
+
+        \param bounds Area covered by the text. Callers usually pass the rect
+            the text is laid out in so that no text extent query is required.
+    */
+    void AddText(const wxString &text, int x, int y, const wxFont &font, const wxColour &colour, const wxRect &bounds);
+
+    /*!
+        Adds a bitmap drawn at (x, y).
+    */
+    void AddBitmap(const wxBitmap &bitmap, int x, int y, bool transparent = false);
+
+    /*!
+        Adds a gradient fill from \a start to \a end.
+
+        \param direction wxHORIZONTAL for a left to right gradient, wxVERTICAL for top to bottom
+    */
+    void AddGradient(const wxRect &rect, const wxColour &start, const wxColour &end, int direction);
+
+    /*!
+        Draws every primitive that intersects \a region, in the order they were added.
+    */
+    void Replay(wxDC &dc, const wxRegion &region) const;
+
+    /*!
+        Fills \a rect with a linear gradient. Shared by gradient primitives and plugins
+        that paint directly.
+    */
+    static void DrawGradient(wxDC &dc, const wxRect &rect, const wxColour &start, const wxColour &end, int direction);
+};
+
 #if IFM_CANFLOAT
 
 /*!
@@ -52,6 +195,11 @@ public:
     wxIFMComponent *m_component;
     bool m_destroyRoot;
 
+private:
+    wxIFMDisplayList m_displayList; //!< recorded contents of this window, used with IFM_DISPLAY_LIST
+    wxBitmap m_backBuffer; //!< back buffer used to paint this window
+    bool m_displayListDirty; //!< true if m_displayList must be rebuilt before the next paint
+
 protected:
     wxIFMFloatingWindowBase(wxIFMInterfacePluginBase *ip);
 
@@ -98,6 +246,14 @@ public:
     wxWindow *GetWindow() const;
     wxIFMComponent *GetComponent() const;
 
+    /*!
+        Disconnects this object from its window and gives up ownership of it. The window
+        will not be destroyed when this object is deleted.
+
+        \return The detached window
+    */
+    wxWindow *DetachWindow();
+
     /*!
         Sends an update component event to the root component using its current size
 
@@ -110,6 +266,12 @@ public:
     */
     void AddPendingUpdate();
 
+    /*!
+        Marks the display list of this window as out of date. It will be rebuilt
+        the next time the window is painted.
+    */
+    void InvalidateDisplayList() { m_displayListDirty = true; }
+
     DECLARE_EVENT_TABLE()
 };
 
@@ -129,6 +291,25 @@ public:
     { }
 };
 
+/*!
+    \brief Area of a window that needs to be repainted.
+
+    \see wxInterfaceManager::AddDamage
+*/
+class WXDLLIMPEXP_IFM wxIFMDamage
+{
+public:
+    wxIFMDamage(wxWindow *window, const wxRect &rect)
+        : m_window(window),
+        m_rect(rect)
+    { }
+
+    wxWindow *m_window; //!< window containing the damaged area
+    wxRect m_rect; //!< damaged area in client coordinates of m_window
+};
+
+WX_DECLARE_EXPORTED_OBJARRAY(wxIFMDamage, wxIFMDamageArray);
+
 /*!
     Main interace management object. Mediates between application
     window and the IFM system.
@@ -159,6 +340,12 @@ private:
     bool m_statusMessageDisplayed;
     wxString m_oldStatusMessage;
 
+    wxIFMDamageArray m_damage; //!< areas waiting to be repainted at the next idle time
+
+    bool RemoveDamage(wxWindow *window);
+    void OnIdle(wxIdleEvent &event);
+    void OnDamagedWindowDestroy(wxWindowDestroyEvent &event);
+
 public:
 
     /*!
@@ -221,11 +408,20 @@ public:
             not be loaded.
         \param flags Specifies any flags.
 
-        Currently the only flag is IFM_NO_RESIZE_UPDATE. If set, the interface
+        If IFM_NO_RESIZE_UPDATE is set, the interface
         will not be automatically updated in response to an EVT_SIZE event sent to its
         parent frame. It is the responsability of the parent frame to call
         wxInterfaceManager::Update in response to EVT_SIZE to update the interface.
 
+        If IFM_RETAINED_DECORATIONS is set, plugins that support it will render
+        component decorations (captions, tabs) once into a cached bitmap and blit
+        that bitmap during paints until the decorations change.
+
+        If IFM_DISPLAY_LIST is set, the interface is recorded into a display list
+        of draw primitives after each layout pass, and paint events replay only the
+        primitives that intersect the update region instead of sending paint events
+        to every component. See wxIFMDisplayList.
+
         \warning If you are not going to be using the default plugins, you must add your
             desired interface plugin(s) before calling this function.
 
@@ -262,6 +458,35 @@ public:
     */
     bool AddChild(wxIFMChildDataBase *data, bool update = false);
 
+    /*!
+        Adds several child windows at once. Storage for their components is allocated up
+        front, and resize sashes are only recalculated once all children have been added.
+
+        \param children Data of the children to add, in the order AddChild would be called
+        \param update If true, the interface will be updated once all children are added
+        \return True if all children were added successfully
+    */
+    bool AddChildren(const wxIFMChildDataArray &children, bool update = false);
+
+    /*!
+        Stores the arrangement of the interface, including floating windows, sizes, and
+        which children are hidden, in a compact string that can be passed to LoadLayout.
+
+        \return The layout, or an empty string if the active interface can't save layouts
+    */
+    wxString SaveLayout();
+
+    /*!
+        Rearranges the interface to match a layout returned by SaveLayout. Children are
+        matched by name, so they must be added before the layout is loaded. Children the
+        layout doesn't mention stay where they are.
+
+        \param layout Layout returned by SaveLayout
+        \param update If true, the interface will be updated once the layout is loaded.
+        \return False if the layout could not be read. The interface is not changed in this case.
+    */
+    bool LoadLayout(const wxString &layout, bool update = true);
+
     /*!
         Shows or hides a child window that is managed by this interface
 
@@ -486,6 +711,31 @@ public:
             by called SetStatusMessagePane with the parameter of IFM_DISABLE_STATUS_MESSAGES.
     */
     void ResetStatusMessage();
+
+    /*!
+        Used by plugins to mark part of a window as needing to be repainted. Plugins should
+        report the exact area whose visuals changed instead of updating whole components.
+
+        Damage is not repainted immediately. It is collected until the next idle event, with
+        overlapping areas of the same window merged, and then flushed with one RefreshRect
+        call per merged area.
+
+        \param window Window containing the damaged area, usually wxIFMComponent::GetParentWindow()
+        \param rect Damaged area in client coordinates of window
+    */
+    void AddDamage(wxWindow *window, const wxRect &rect);
+
+    /*!
+        Immediately repaints all outstanding damage.
+    */
+    void FlushDamage();
+
+    /*!
+        Forgets all outstanding damage for the given window without repainting it.
+    */
+    void DiscardDamage(wxWindow *window);
+
+    DECLARE_EVENT_TABLE()
 };
 
 /*!
@@ -529,6 +779,58 @@ public:
     DECLARE_DYNAMIC_CLASS(wxIFMChildDataBase)
 };
 
+/*!
+    \brief Compact reference to a component that can be kept after the component is deleted.
+
+    A handle is an index into the component store plus the generation of that slot. Deleting a
+    component bumps the generation of its slot, so handles to it stop resolving even if the
+    slot or the memory of the component is reused later. Queued work and caches should keep
+    handles instead of component pointers.
+*/
+class WXDLLIMPEXP_IFM wxIFMComponentHandle
+{
+    friend class wxIFMComponent;
+
+private:
+    unsigned int m_index; //!< slot in the component store
+    unsigned int m_generation; //!< generation of the slot when the handle was made, 0 for null handles
+
+    wxIFMComponentHandle(unsigned int index, unsigned int generation)
+        : m_index(index),
+        m_generation(generation)
+    { }
+
+public:
+
+    /*!
+        Creates a null handle
+    */
+    wxIFMComponentHandle()
+        : m_index(0),
+        m_generation(0)
+    { }
+
+    /*!
+        \return The component this handle refers to, or NULL if it was deleted
+    */
+    wxIFMComponent *Get() const;
+
+    /*!
+        \return True if the component this handle refers to still exists
+    */
+    bool IsOk() const { return Get() != NULL; }
+
+    bool operator == (const wxIFMComponentHandle &handle) const
+    {
+        return m_index == handle.m_index && m_generation == handle.m_generation;
+    }
+
+    bool operator != (const wxIFMComponentHandle &handle) const
+    {
+        return !(*this == handle);
+    }
+};
+
 /*!
     \brief Class representing a generic component in the interface.
 */
@@ -536,11 +838,44 @@ class WXDLLIMPEXP_IFM wxIFMComponent
 {
 private:
 
-    wxIFMComponentDataMap m_data;
+    wxIFMExtensionDataBase *m_slots[IFM_COMPONENT_DATA_SLOTS]; //!< data indexed by key
+    wxIFMComponentDataMap m_data; //!< data with keys that don't fit into m_slots
     int m_type; //!< type of component
     wxIFMInterfacePluginBase *m_ip;
     wxInterfaceManager *GetManager();
 
+    wxRect m_bounds; //!< m_rect united with the bounds of all visible children
+    bool m_boundsDirty; //!< m_bounds needs to be recalculated
+
+    // pre and post order positions of this component in a walk of its tree, used by IsChildOf
+    int m_treeEnter, m_treeExit;
+    wxIFMComponent *m_treeRoot; //!< root of the tree the labels were assigned in
+    unsigned long m_treeGeneration; //!< labels are valid while this equals ms_treeGeneration
+    static unsigned long ms_treeGeneration;
+
+    void LabelTree(wxIFMComponent *root, int &counter);
+
+    wxIFMComponentHandle m_handle; //!< handle to this component
+
+    int m_visibleChildren; //!< number of visible children
+    int m_visibleLeaves; //!< number of visible non container descendants, counting through containers
+
+    /*!
+        \return What this component adds to the visible leaf count of its parent
+    */
+    int GetVisibleContribution();
+
+    /*!
+        Adds the given deltas to the visible counts of this component, the leaf delta is also
+        passed on to parents for as long as they are containers.
+    */
+    void AdjustVisibleCounts(int children, int leaves);
+
+    /*!
+        Updates the counts of the parent after the visibility of this component changed
+    */
+    void VisibilityUpdated(bool was_visible, int old_contribution);
+
 public:
 
     wxRect m_rect; //!< size and position of the component
@@ -592,6 +927,28 @@ public:
 
     ~wxIFMComponent();
 
+#if IFM_USE_COMPONENT_SLABS
+    static void *operator new(size_t size);
+    static void operator delete(void *block, size_t size);
+#endif
+
+    /*!
+        Returns memory cached for components and extension data to the system once
+        all of them have been deleted. Called by wxInterfaceManager::Shutdown.
+    */
+    static void ReleaseUnusedMemory();
+
+    /*!
+        Allocates storage for count more components ahead of time. Used when adding many
+        children at once.
+    */
+    static void ReserveComponents(size_t count);
+
+    /*!
+        \return A handle to this component that can be resolved safely after it is deleted
+    */
+    wxIFMComponentHandle GetHandle() const;
+
     /*!
         Called by plugins to add data storage to this component.
 
@@ -640,18 +997,72 @@ public:
     /*!
         \return True if \a child is a child of \a parent
 
+        The component tree is labeled with pre and post order positions the first time this
+        is called after the tree changed, later calls only compare labels.
+
         \warning This function may be removed in a future release
     */
     static bool IsChildOf(wxIFMComponent *parent, wxIFMComponent *child);
 
     /*!
-        Paints this component by sending PAINT_BACKGROUND, PAINTBORDER, and PAINT_DECOR events
+        Marks the labels used by IsChildOf as out of date. Must be called whenever a component
+        is added to or removed from the children of another component.
+    */
+    static void InvalidateTreeLabels();
 
-        \param dc DC to paint on
-        \param region Region that needs painting
+    /*!
+        Updates the visible child counts of this component and its parents. Must be called
+        right after \a child was added to or removed from m_children.
+
+        \param child The child that was added or removed
+        \param added True if the child was added, false if it was removed
+    */
+    void ChildrenChanged(wxIFMComponent *child, bool added);
+
+    /*!
+        \return Number of visible direct children of this component
+    */
+    int GetVisibleChildCount() const;
+
+    /*!
+        \return Number of visible non container components below this component.
+            Child containers are not counted themselves, but their children are.
+    */
+    int GetVisibleLeafCount() const;
+
+    /*!
+        Paints this component by sending PAINT_BACKGROUND, PAINTBORDER, and PAINT_DECOR events,
+        then paints each visible child whose bounds intersect the region.
+
+        \param dc DC to paint on. The caller is responsible for clipping it to the update region,
+            this is done once per paint instead of once per component.
+        \param region Region that needs painting. Children are given this region intersected with
+            their bounds.
     */
     void Paint(wxDC &dc, const wxRegion &region);
 
+    /*!
+        \return The smallest rect containing this component and all of its visible descendants.
+            This is used while painting to skip entire subtrees outside of the update region.
+    */
+    const wxRect &GetBounds();
+
+    /*!
+        Marks the bounds of this component and all of its parents as out of date.
+        This must be called whenever m_rect changes or a child is shown or hidden.
+        Stops at the first component that is already out of date, as its parents are too.
+    */
+    void InvalidateBounds();
+
+    /*!
+        Records this component and its visible children into a display list by sending
+        wxEVT_IFM_BUILDDISPLAYLIST events for the background, border, and decorations,
+        in the same order Paint would paint them.
+
+        \param list Display list to add primitives to
+    */
+    void BuildDisplayList(wxIFMDisplayList &list);
+
     /*!
         \return The type of the component
     */
@@ -742,6 +1153,12 @@ public:
 
     virtual ~wxIFMExtensionDataBase();
 
+    // wxObject has its own operator new when tracing memory
+#if IFM_USE_COMPONENT_SLABS && !(defined(__WXDEBUG__) && wxUSE_MEMORY_TRACING)
+    static void *operator new(size_t size);
+    static void operator delete(void *block, size_t size);
+#endif
+
     /*!
         \return Key used to retrieve this data
     */
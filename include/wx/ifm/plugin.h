@@ -15,6 +15,69 @@
 #include "wx/ifm/manager.h"
 #include "wx/ifm/events.h"
 
+#include "wx/timer.h"
+
+#define IFM_MOTION_FRAME_INTERVAL 16 //!< minimum milliseconds between two coalesced motion events
+
+#define IFM_CHILD_WINDOW_MAP_SIZE 16 //!< initial number of slots in a wxIFMChildWindowMap
+
+/*!
+    \brief Maps child windows to the components that own them.
+
+    Open addressing table keyed by the window pointer. Looking up a window that is
+    not in the table does not add it.
+*/
+class WXDLLIMPEXP_IFM wxIFMChildWindowMap
+{
+private:
+
+    struct Entry
+    {
+        wxWindow *m_window; //!< NULL for empty slots
+        wxIFMComponent *m_component;
+    };
+
+    Entry *m_entries;
+    size_t m_capacity; //!< always a power of two
+    size_t m_count;
+
+public:
+
+    wxIFMChildWindowMap();
+    ~wxIFMChildWindowMap();
+
+    /*!
+        Associates the window with the component, replacing any previous association.
+    */
+    void Insert(wxWindow *window, wxIFMComponent *component);
+
+    /*!
+        \return The component associated with the window, or NULL
+    */
+    wxIFMComponent *Find(const wxWindow *window) const;
+
+    /*!
+        \return true if the window was in the table
+    */
+    bool Remove(const wxWindow *window);
+
+    void Clear();
+
+    /*!
+        Grows the table so that count more windows can be inserted without growing again.
+    */
+    void Reserve(size_t count);
+
+private:
+
+    size_t GetSlot(const wxWindow *window) const;
+    void Grow();
+    void Rehash(size_t capacity);
+
+    wxIFMChildWindowMap(const wxIFMChildWindowMap &);
+    wxIFMChildWindowMap &operator=(const wxIFMChildWindowMap &);
+};
+
 /*!
     Interface plugin base class
 */
@@ -23,6 +86,7 @@ class WXDLLIMPEXP_IFM wxIFMInterfacePluginBase : public wxEvtHandler
 private:
     wxInterfaceManager *m_manager;
     wxIFMExtensionPluginBase *m_topExtensionPlugin;
+    wxBitmap m_backBuffer; //!< back buffer used to paint the managed window
 
 protected:
     wxIFMComponentArray m_components;
@@ -89,6 +153,14 @@ public:
     */
     void AddPendingPluginEvent(wxIFMPluginEvent &event);
 
+    /*!
+        \brief Discards any recorded display lists so they are rebuilt on the next paint.
+
+        Called whenever a component is updated. Interface plugins that support
+        IFM_DISPLAY_LIST should override this.
+    */
+    virtual void InvalidateDisplayLists() { }
+
     /*!
         Return the component at the given position or NULL if none found within the children
         of the given component and the component itself.
@@ -119,6 +191,13 @@ public:
     */
     void AddChildWindow(wxWindow *window, wxIFMComponent *component);
 
+    /*!
+        \brief Removes a child window from the interface plugin.
+
+        Called automatically when the component owning the child window is deleted.
+    */
+    void RemoveChildWindow(wxWindow *window);
+
     /*!
         Return the floating component the mouse is within or NULL if the mouse is not
         over a floating component
@@ -181,4 +260,57 @@ public:
     DECLARE_DYNAMIC_CLASS_NO_COPY(wxIFMExtensionPluginBase)
 };
 
+/*!
+    Coalesces mouse motion for extension plugins that do expensive work on every motion
+    event, like dragging and resizing.
+
+    At most one motion event is processed every IFM_MOTION_FRAME_INTERVAL milliseconds.
+    Motion arriving faster than that replaces the pending motion, which is redelivered
+    through the interface plugin as a wxEVT_IFM_MOTION event once the interval has elapsed.
+    Hint windows and live resizing follow scheduled motion directly and are not throttled again.
+*/
+class WXDLLIMPEXP_IFM wxIFMMotionScheduler : public wxEvtHandler
+{
+private:
+
+    wxIFMInterfacePluginBase *m_ip;
+    wxIFMComponent *m_component;
+    wxMouseEvent m_event;
+    bool m_pending, m_dispatching;
+    wxStopWatch m_sinceDispatch; //!< time since the last motion was processed
+    wxTimer m_timer;
+
+public:
+
+    wxIFMMotionScheduler();
+
+    /*!
+        Sets the interface plugin pending motion is redelivered through.
+    */
+    void SetPlugin(wxIFMInterfacePluginBase *plugin);
+
+    /*!
+        \return true if the motion event should be processed now. Otherwise the event
+        replaces any pending motion and will be redelivered later.
+    */
+    bool Schedule(wxIFMMouseEvent &event);
+
+    /*!
+        Delivers the pending motion immediately, if there is one. Call this before processing
+        a button release so the final pointer position is never dropped.
+    */
+    void Flush();
+
+    /*!
+        Discards the pending motion, if there is one.
+    */
+    void Cancel();
+
+private:
+
+    void OnTimer(wxTimerEvent &event);
+
+    DECLARE_EVENT_TABLE()
+};
+
 #endif
@@ -17,11 +17,13 @@
 #include "wx/ifm/definterface.h"
 
 #include "wx/dc.h"
-#include "wx/dcscreen.h"
 
 #define IFM_RESIZE_SASH_BORDER  0
 #define IFM_RESIZE_SASH_SIZE    (4 + IFM_RESIZE_SASH_BORDER * 2)
 
+#define IFM_RESIZE_SUBTREE_RESIZEABLE   0x1 //!< a visible, non fixed component lies below this one
+#define IFM_RESIZE_SUBTREE_VISIBLE      0x2 //!< a visible non container component lies below this one
+
 class WXDLLIMPEXP_IFM wxIFMResizeEvent;
 class WXDLLIMPEXP_IFM wxIFMUpdateResizeSashEvent;
 
@@ -48,17 +50,28 @@ private:
     int m_orientation;
     int m_offset;
 
+    wxIFMHintWindow *m_hint; //!< created on the first non realtime resize
+
+    // live resize state, see IFM_LIVE_RESIZE
+    bool m_realtime;
+    wxIFMComponent *m_resizeComponent, *m_liveNeighbour;
+    wxSize m_liveOldSize, m_liveOldNeighbourSize; //!< desired sizes to restore if the resize is canceled
+
+    wxIFMMotionScheduler m_motion;
+
 public:
 
     wxIFMDefaultResizePlugin();
 
     bool Initialize(wxIFMInterfacePluginBase *plugin);
+    void Shutdown();
 
     void OnCreateComponent(wxIFMNewComponentEvent &event);
     void OnDock(wxIFMDockEvent &event);
     void OnUndock(wxIFMUndockEvent &event);
     void OnConvertRect(wxIFMConvertRectEvent &event);
     void OnPaintDecor(wxIFMPaintEvent &event);
+    void OnBuildDisplayList(wxIFMDisplayListEvent &event);
     void OnShowComponent(wxIFMShowComponentEvent &event);
     void OnGetRect(wxIFMRectEvent &event);
     void OnSetRect(wxIFMRectEvent &event);
@@ -72,18 +85,48 @@ public:
     void OnFloat(wxIFMFloatEvent &event);
 #endif
 
-    void PaintResizeHint(wxScreenDC &dc, const wxRect &rect);
+    void ShowResizeHint(const wxRect &rect);
 
     void OnResizeBegin(wxIFMResizeEvent &event);
     void OnResizeEnd(wxIFMResizeEvent &event);
     void OnResizing(wxIFMResizeEvent &event);
 
+    /*!
+        \return The new size of a component whose sash was dragged to the given position
+    */
+    wxSize GetResizeSize(wxIFMComponent *component, wxPoint pos);
+
+    /*!
+        \return The visible sibling on the other side of the component's resize sash, if any
+    */
+    wxIFMComponent *GetResizeNeighbour(wxIFMComponent *component);
+
+    /*!
+        Resizes the component being live resized and its neighbour to follow the mouse,
+        leaving every other sibling untouched.
+    */
+    void ApplyLiveResize(const wxPoint &pos);
+
+    /*!
+        Resizes a component to the given size by moving the edge it shares with neighbour.
+        Only the two components are updated, the rest of the container is left alone.
+    */
+    void ResizeNeighbours(wxIFMComponent *component, wxIFMComponent *neighbour, wxSize size);
+    void UpdateResizeParent(wxIFMComponent *component);
+
     void OnAddTopContainer(wxIFMAddTopContainerEvent &event);
 
     void OnUpdate(wxIFMUpdateEvent &event);
     void OnUpdateResizeSashes(wxIFMUpdateResizeSashEvent &event);
     void UpdateContainerResizeSashes(wxIFMComponent *container);
-    void UpdateResizeSashes(wxIFMComponent *component);
+
+    /*!
+        Sets the side and visibility of the resize sashes of a component and all of its
+        visible descendants in a single post-order pass.
+
+        \return IFM_RESIZE_SUBTREE_* flags describing the component's descendants
+    */
+    int UpdateResizeSashes(wxIFMComponent *component);
     void ResizeComponent(wxIFMComponent *component, wxSize size);
     bool HasResizeableChildren(wxIFMComponent *component);
 
@@ -105,6 +148,7 @@ public:
                     can be IFM_ORIENTATION_(LEFT|RIGHT|TOP|BOTTOM) */
     bool m_display; //!< whether or not to display a resize sash
     wxRect m_rect; //!< resize sash rect
+    int m_index; //!< position within the parent's children when the sashes were last updated, -1 if unknown
 
     wxIFMComponentDataKeyType GetDataKey() const;
     static wxIFMComponentDataKeyType DataKey();
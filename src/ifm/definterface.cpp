@@ -78,6 +78,13 @@ wxIFMFloatingFrame::wxIFMFloatingFrame(wxIFMInterfacePluginBase *ip, wxWindow *p
     ConnectEvents();
 }
 
+wxIFMFloatingFrame::wxIFMFloatingFrame(wxIFMInterfacePluginBase *ip, wxFrame *frame)
+        : wxIFMFloatingWindowBase(ip)
+{
+    m_window = frame;
+    ConnectEvents();
+}
+
 void wxIFMFloatingFrame::OnClose(wxCloseEvent &event)
 {
     // don't know if this works, but at least try to close properly
@@ -105,6 +112,9 @@ wxIFMDefaultInterfacePlugin implementation
 BEGIN_EVENT_TABLE(wxIFMDefaultInterfacePlugin, wxIFMInterfacePluginBase)
     EVT_IFM_DELETECOMPONENT (wxIFMDefaultInterfacePlugin::OnDeleteComponent)
     EVT_IFM_ADDCHILD    (wxIFMDefaultInterfacePlugin::OnAddChild)
+    EVT_IFM_ADDCHILDREN (wxIFMDefaultInterfacePlugin::OnAddChildren)
+    EVT_IFM_SAVELAYOUT  (wxIFMDefaultInterfacePlugin::OnSaveLayout)
+    EVT_IFM_LOADLAYOUT  (wxIFMDefaultInterfacePlugin::OnLoadLayout)
     EVT_IFM_UPDATE      (wxIFMDefaultInterfacePlugin::OnUpdate)
     EVT_IFM_PAINTINTERFACE (wxIFMDefaultInterfacePlugin::OnPaint)
     EVT_IFM_GETCONTENTRECT(wxIFMDefaultInterfacePlugin::OnGetContentRect)
@@ -116,16 +126,30 @@ BEGIN_EVENT_TABLE(wxIFMDefaultInterfacePlugin, wxIFMInterfacePluginBase)
     EVT_IFM_CREATEFLOATINGWINDOW    (wxIFMDefaultInterfacePlugin::OnCreateFloatingWindow)
     EVT_IFM_DESTROYFLOATINGWINDOW   (wxIFMDefaultInterfacePlugin::OnDestroyFloatingWindow)
     //EVT_IFM_FLOAT                   (wxIFMDefaultInterfacePlugin::OnFloat)
+    EVT_TIMER                       (wxID_ANY, wxIFMDefaultInterfacePlugin::OnFramePoolTimer)
 #endif
 END_EVENT_TABLE()
 
 wxIFMDefaultInterfacePlugin::wxIFMDefaultInterfacePlugin()
-    : wxIFMInterfacePluginBase()
-{ }
+    : wxIFMInterfacePluginBase(),
+    m_bulkUpdate(0),
+    m_containerListDirty(false),
+    m_displayListDirty(true)
+#if IFM_CANFLOAT
+    ,m_framePoolSize(IFM_FLOATING_FRAME_POOL_SIZE)
+#endif
+{
+#if IFM_CANFLOAT
+    m_framePoolTimer.SetOwner(this);
+#endif
+}
 
 wxIFMDefaultInterfacePlugin::~wxIFMDefaultInterfacePlugin()
 {
 #if IFM_CANFLOAT
+    m_framePoolTimer.Stop();
+    TrimFramePool(0);
+
     // delete floating window objects
     for( int i = 0, count = m_floatingWindows.GetCount(); i < count; ++i )
     //for( wxIFMFloatingWindowArray::const_iterator i = m_floatingWindows.begin(), end = m_floatingWindows.end(); i != end; ++i )
@@ -136,9 +160,57 @@ wxIFMDefaultInterfacePlugin::~wxIFMDefaultInterfacePlugin()
 
 const wxIFMComponentList &wxIFMDefaultInterfacePlugin::GetTopContainerList() const
 {
+    if( m_containerListDirty )
+    {
+        m_containers.Clear();
+        for( size_t i = 0, count = m_topContainers.GetCount(); i < count; ++i )
+            m_containers.Append(m_topContainers[i]);
+        m_containerListDirty = false;
+    }
+
     return m_containers;
 }
 
+const wxIFMComponentArray &wxIFMDefaultInterfacePlugin::GetTopContainers() const
+{
+    return m_topContainers;
+}
+
+int wxIFMDefaultInterfacePlugin::GetTopContainerIndex(wxIFMComponent *container) const
+{
+    if( !container )
+        return -1;
+
+    wxIFMContainerData *data = IFM_GET_EXTENSION_DATA(container, wxIFMContainerData);
+    if( !data || data->m_index < 0 || data->m_index >= (int)m_topContainers.GetCount() ||
+        m_topContainers[data->m_index] != container )
+        return -1;
+
+    return data->m_index;
+}
+
+void wxIFMDefaultInterfacePlugin::UpdateTopContainerIndices(int start)
+{
+    for( int i = start, count = m_topContainers.GetCount(); i < count; ++i )
+    {
+        wxIFMContainerData *data = IFM_GET_EXTENSION_DATA(m_topContainers[i], wxIFMContainerData);
+        if( data )
+            data->m_index = i;
+    }
+
+    m_containerListDirty = true;
+}
+
+void wxIFMDefaultInterfacePlugin::RemoveTopContainer(int index)
+{
+    wxIFMContainerData *data = IFM_GET_EXTENSION_DATA(m_topContainers[index], wxIFMContainerData);
+    if( data )
+        data->m_index = -1;
+
+    m_topContainers.RemoveAt(index);
+    UpdateTopContainerIndices(index);
+}
+
 bool wxIFMDefaultInterfacePlugin::ProcessPluginEvent(wxIFMPluginEvent &event)
 {
     bool ret = wxIFMInterfacePluginBase::ProcessPluginEvent(event);
@@ -152,9 +224,41 @@ bool wxIFMDefaultInterfacePlugin::ProcessPluginEvent(wxIFMPluginEvent &event)
     }
 #endif
 
+    // appearance changes that don't go through a component update make the display lists stale too
+    wxEventType type = event.GetEventType();
+    if( type == wxEVT_IFM_UPDATECONFIG || type == wxEVT_IFM_SELECTTAB )
+        InvalidateDisplayLists();
+
     return ret;
 }
 
+void wxIFMDefaultInterfacePlugin::InvalidateDisplayLists()
+{
+    m_displayListDirty = true;
+
+#if IFM_CANFLOAT
+    for( size_t i = 0; i < m_floatingWindows.GetCount(); i++ )
+        m_floatingWindows[i]->InvalidateDisplayList();
+#endif
+}
+
+void wxIFMDefaultInterfacePlugin::BeginBulkUpdate()
+{
+    m_bulkUpdate++;
+}
+
+void wxIFMDefaultInterfacePlugin::EndBulkUpdate()
+{
+    wxASSERT_MSG(m_bulkUpdate > 0, wxT("EndBulkUpdate without BeginBulkUpdate"));
+    if( m_bulkUpdate > 0 )
+        m_bulkUpdate--;
+}
+
+bool wxIFMDefaultInterfacePlugin::InBulkUpdate() const
+{
+    return m_bulkUpdate > 0;
+}
+
 void wxIFMDefaultInterfacePlugin::OnAddTopContainer(wxIFMAddTopContainerEvent &event)
 {
     wxIFMComponent *component = event.GetComponent();
@@ -163,48 +267,30 @@ void wxIFMDefaultInterfacePlugin::OnAddTopContainer(wxIFMAddTopContainerEvent &e
     if( !component )
         return;
 
+    int count = m_topContainers.GetCount();
+    int pos;
+
     if( event.GetIndexMode() )
     {
-        int index = event.GetIndex();
-
-        if( index == -1 )
-        {
-            m_containers.push_back(component);
-        }
-        else
-        {
-            // get an interator to the index position
-            if( index == 0 )
-                m_containers.push_front(component);
-            else
-            {
-                wxIFMComponentList::iterator i; int n;
-                for( i = m_containers.begin(), n = 0; n < index; ++i, n++ );
-                m_containers.insert(i, component);
-            }
-        }
+        pos = event.GetIndex();
+        if( pos == -1 || pos > count )
+            pos = count;
     }
     else
     {
         // find the index of the index container
-        wxIFMComponent *index = event.GetIndexContainer();
-        wxIFMComponentList::iterator i, end;
-        for( i = m_containers.begin(), end = m_containers.end(); i != end; ++i)
-        {
-            if( *i == index )
-                break;
-        }
+        pos = GetTopContainerIndex(event.GetIndexContainer());
 
         // dock before or after this index
-        if( !event.GetIndex() ) // GetIndex() == 0 means dock after
-            i++;
-        // dont advance to the end of the list
-        if( i == end )
-            m_containers.push_back(component);
-        else
-            m_containers.insert(i, component);
+        if( pos == -1 )
+            pos = count;
+        else if( !event.GetIndex() ) // GetIndex() == 0 means dock after
+            pos++;
     }
 
+    m_topContainers.Insert(component, pos);
+    UpdateTopContainerIndices(pos);
+
 #if IFM_CANFLOAT
     // if a container is moved from a floating window into a top level position, it needs
     // to recieve float notify events, or child windows fall off the face of the earth
@@ -221,20 +307,18 @@ void wxIFMDefaultInterfacePlugin::OnRemoveTopContainer(wxIFMRemoveTopContainerEv
     if( !container )
         return;
 
-    for( wxIFMComponentList::iterator i = m_containers.begin(), end = m_containers.end(); i != end; ++i )
+    int index = GetTopContainerIndex(container);
+    if( index != -1 )
     {
-        if( *i == container )
-        {
-            m_containers.erase(i);
+        RemoveTopContainer(index);
 
-            // give the container no orientation value
-            wxIFMContainerData *data = IFM_GET_EXTENSION_DATA(container, wxIFMContainerData);
-            wxASSERT_MSG(data, wxT("Container with no container data?"));
-            if( data )
-                data->m_orientation = IFM_ORIENTATION_NONE;
+        // give the container no orientation value
+        wxIFMContainerData *data = IFM_GET_EXTENSION_DATA(container, wxIFMContainerData);
+        wxASSERT_MSG(data, wxT("Container with no container data?"));
+        if( data )
+            data->m_orientation = IFM_ORIENTATION_NONE;
 
-            return;
-        }
+        return;
     }
 
     wxFAIL_MSG(wxT("Trying to remove a container not in top level list!"));
@@ -264,18 +348,75 @@ bool wxIFMDefaultInterfacePlugin::Initialize(wxInterfaceManager *m_manager)
     if( !PushExtensionPlugin(plugin) )
         return false;
 
+#if IFM_CANFLOAT
+    FillFramePool();
+#endif
+
     return true;
 }
 
+void wxIFMDefaultInterfacePlugin::Shutdown()
+{
+#if IFM_CANFLOAT
+    m_framePoolTimer.Stop();
+    TrimFramePool(0);
+#endif
+
+    wxIFMInterfacePluginBase::Shutdown();
+}
+
+#if IFM_CANFLOAT
+void wxIFMDefaultInterfacePlugin::SetFloatingFramePoolSize(int size)
+{
+    wxASSERT_MSG(size >= 0, wxT("Negative floating frame pool size"));
+    if( size < 0 )
+        return;
+
+    m_framePoolSize = size;
+
+    TrimFramePool(size);
+    if( GetManager() )
+        FillFramePool();
+}
+
+int wxIFMDefaultInterfacePlugin::GetFloatingFramePoolSize() const
+{
+    return m_framePoolSize;
+}
+
+void wxIFMDefaultInterfacePlugin::FillFramePool()
+{
+    while( (int)m_framePool.GetCount() < m_framePoolSize )
+    {
+        wxFrame *frame = new wxFrame(GetManager()->GetParent(), wxID_ANY, wxT(""),
+            wxPoint(0,0), wxSize(0,0), IFM_FLOATING_FRAME_STYLE);
+        m_framePool.push_back(frame);
+    }
+}
+
+void wxIFMDefaultInterfacePlugin::TrimFramePool(int size)
+{
+    while( (int)m_framePool.GetCount() > size )
+    {
+        m_framePool.Last()->Destroy();
+        m_framePool.RemoveAt(m_framePool.GetCount() - 1);
+    }
+}
+
+void wxIFMDefaultInterfacePlugin::OnFramePoolTimer(wxTimerEvent &WXUNUSED(event))
+{
+    if( GetManager() )
+        FillFramePool();
+}
+#endif
+
 wxIFMComponent *wxIFMDefaultInterfacePlugin::GetContainer(int orientation)
 {
     // look for the last container with the specified orientation
     // FIXME: This actually finds the first container?
-    //for( wxIFMComponentList::compatibility_iterator node = m_containers.GetFirst(); node; node = node->GetNext() )
-    for( wxIFMComponentList::const_iterator i = m_containers.begin(), end = m_containers.end(); i != end; ++i )
+    for( size_t i = 0, count = m_topContainers.GetCount(); i < count; ++i )
     {
-        //wxIFMComponent *container = node->GetData();
-        wxIFMComponent *container = (*i);
+        wxIFMComponent *container = m_topContainers[i];
         wxIFMContainerData *data = IFM_GET_EXTENSION_DATA(container, wxIFMContainerData);
         if( data->m_orientation == orientation )
             return container;
@@ -292,14 +433,9 @@ void wxIFMDefaultInterfacePlugin::OnDeleteComponent(wxIFMDeleteComponentEvent &e
         wxIFMComponent *container = event.GetComponent();
 
         // remove the container from the top level container list
-        for( wxIFMComponentList::iterator i = m_containers.begin(), end = m_containers.end(); i != end; ++i )
-        {
-            if( *i == container )
-            {
-                m_containers.erase(i);
-                break;
-            }
-        }
+        int index = GetTopContainerIndex(container);
+        if( index != -1 )
+            RemoveTopContainer(index);
     }
 
     event.Skip();
@@ -308,8 +444,9 @@ void wxIFMDefaultInterfacePlugin::OnDeleteComponent(wxIFMDeleteComponentEvent &e
 void wxIFMDefaultInterfacePlugin::OnAddChild(wxIFMAddChildEvent &event)
 {
     static int s_nextOrientation = IFM_ORIENTATION_TOP; // for default orientation selection
-    static wxIFMComponent *last_panel;
+    static wxIFMComponentHandle last_panel_handle; // the panel may be deleted before the next child is added
     static bool last_panel_floating;
+    wxIFMComponent *last_panel = last_panel_handle.Get();
     bool delete_data = false;
 
     wxIFMChildDataBase *base = event.GetChildData();
@@ -473,7 +610,10 @@ void wxIFMDefaultInterfacePlugin::OnAddChild(wxIFMAddChildEvent &event)
 
     // the tabs parent will be a panel automagically, so we store that
     // as the previously used panel for tabify
-    last_panel = tab->m_parent;
+    if( tab->m_parent )
+        last_panel_handle = tab->m_parent->GetHandle();
+    else
+        last_panel_handle = wxIFMComponentHandle();
 
     // show or hide the new component
     tab->Show(!data->m_hidden, false);
@@ -485,6 +625,588 @@ void wxIFMDefaultInterfacePlugin::OnAddChild(wxIFMAddChildEvent &event)
         delete data;
 }
 
+void wxIFMDefaultInterfacePlugin::OnAddChildren(wxIFMAddChildrenEvent &event)
+{
+    const wxIFMChildDataArray &children = event.GetChildren();
+    size_t count = children.GetCount();
+
+    // most children get a tab and a panel
+    m_components.Alloc(m_components.GetCount() + count * 2);
+    wxIFMComponent::ReserveComponents(count * 2);
+    m_windows.Reserve(count);
+
+    BeginBulkUpdate();
+
+    // extension plugins still see each child being added
+    int added = 0;
+    for( size_t i = 0; i < count; ++i )
+    {
+        wxIFMAddChildEvent evt(children[i]);
+        ProcessPluginEvent(evt);
+        if( evt.GetSuccess() )
+            added++;
+    }
+
+    EndBulkUpdate();
+
+    InvalidateDisplayLists();
+    event.SetAddedCount(added);
+}
+
+/*
+    Saved layouts are a list of whitespace separated fields:
+
+    IFM <version> <top container count> <component>... <floating window count> <floating window>...
+
+    component:          C <orientation> <alignment> <width> <height> <child count> <component>...
+                        P <width> <height> <selected child> <child count> <component>...
+                        T <hidden> <width> <height> <name length>:<name>
+                        X (components of other types, ignored when loading)
+    floating window:    <x> <y> <width> <height> <component>
+
+    Widths and heights are desired sizes in client coordinates, floating windows store the
+    rect of their frame.
+
+    Top level containers have a top, bottom, left or right orientation, floating window roots
+    are floating containers and containers inside containers are docked. Containers hold any
+    component, panels only hold tabs.
+*/
+class wxIFMLayoutNode;
+WX_DEFINE_ARRAY(wxIFMLayoutNode *, wxIFMLayoutNodeArray);
+WX_DECLARE_STRING_HASH_MAP(wxIFMComponent *, wxIFMLayoutTabMap);
+
+/*
+    A component read from a saved layout
+*/
+class wxIFMLayoutNode
+{
+public:
+    wxChar m_type; //!< C, P, T or X
+    int m_orientation, m_alignment; //!< containers only
+    int m_selected; //!< index of the selected child of panels
+    bool m_hidden; //!< tabs only
+    wxSize m_desiredSize;
+    wxRect m_rect; //!< frame rect of floating window roots
+    wxString m_name; //!< tabs only
+    wxIFMLayoutNodeArray m_children;
+    wxIFMComponent *m_component; //!< component this node was loaded into
+
+    wxIFMLayoutNode()
+        : m_type(wxT('X')),
+        m_orientation(IFM_ORIENTATION_NONE),
+        m_alignment(IFM_ALIGN_NONE),
+        m_selected(0),
+        m_hidden(false),
+        m_component(NULL)
+    { }
+
+    ~wxIFMLayoutNode()
+    {
+        for( size_t i = 0; i < m_children.GetCount(); ++i )
+            delete m_children[i];
+    }
+};
+
+/*
+    Reads the fields of a saved layout. Any error makes IsOk return false, after which
+    all reads return empty values.
+*/
+class wxIFMLayoutReader
+{
+private:
+    const wxString &m_layout;
+    size_t m_pos;
+    bool m_ok;
+
+    void SkipSpace()
+    {
+        while( m_pos < m_layout.Length() && wxIsspace(m_layout[m_pos]) )
+            m_pos++;
+    }
+
+public:
+    wxIFMLayoutReader(const wxString &layout)
+        : m_layout(layout),
+        m_pos(0),
+        m_ok(true)
+    { }
+
+    bool IsOk() const { return m_ok; }
+
+    /*
+        Marks the layout as invalid
+    */
+    void Fail() { m_ok = false; }
+
+    wxChar ReadChar()
+    {
+        SkipSpace();
+        if( !m_ok || m_pos >= m_layout.Length() )
+        {
+            m_ok = false;
+            return 0;
+        }
+        return m_layout[m_pos++];
+    }
+
+    int ReadInt()
+    {
+        SkipSpace();
+        if( !m_ok )
+            return 0;
+
+        bool negative = false;
+        if( m_pos < m_layout.Length() && m_layout[m_pos] == wxT('-') )
+        {
+            negative = true;
+            m_pos++;
+        }
+
+        size_t start = m_pos;
+        int value = 0;
+        while( m_pos < m_layout.Length() && wxIsdigit(m_layout[m_pos]) && m_pos - start < 9 )
+            value = value * 10 + (m_layout[m_pos++] - wxT('0'));
+
+        // no digits, or too many for an int
+        if( m_pos == start || (m_pos < m_layout.Length() && wxIsdigit(m_layout[m_pos])) )
+        {
+            m_ok = false;
+            return 0;
+        }
+
+        return negative ? -value : value;
+    }
+
+    wxString ReadName()
+    {
+        int length = ReadInt();
+        if( ReadChar() != wxT(':') || length < 0 || m_pos + length > m_layout.Length() )
+        {
+            m_ok = false;
+            return wxEmptyString;
+        }
+
+        wxString name = m_layout.Mid(m_pos, length);
+        m_pos += length;
+        return name;
+    }
+
+    /*
+        Reads a component and its children. Always returns a node which the caller must delete,
+        check IsOk to see if it was read correctly.
+
+        \param parent Type of the node this one is a child of, 0 for top level and floating
+            window roots. The caller checks the orientation of those.
+    */
+    wxIFMLayoutNode *ReadNode(int depth, wxChar parent = 0)
+    {
+        wxIFMLayoutNode *node = new wxIFMLayoutNode;
+        int count = 0;
+
+        if( depth > IFM_LAYOUT_MAX_DEPTH )
+        {
+            m_ok = false;
+            return node;
+        }
+
+        node->m_type = ReadChar();
+        switch( node->m_type )
+        {
+            case wxT('C'):
+                node->m_orientation = ReadInt();
+                node->m_alignment = ReadInt();
+                node->m_desiredSize.x = ReadInt();
+                node->m_desiredSize.y = ReadInt();
+                count = ReadInt();
+                break;
+            case wxT('P'):
+                node->m_desiredSize.x = ReadInt();
+                node->m_desiredSize.y = ReadInt();
+                node->m_selected = ReadInt();
+                count = ReadInt();
+                break;
+            case wxT('T'):
+                node->m_hidden = ReadInt() != 0;
+                node->m_desiredSize.x = ReadInt();
+                node->m_desiredSize.y = ReadInt();
+                node->m_name = ReadName();
+                break;
+            case wxT('X'):
+                break;
+            default:
+                m_ok = false;
+        }
+
+        if( count < 0 )
+            m_ok = false;
+
+        // panels only hold tabs
+        if( parent == wxT('P') && node->m_type != wxT('T') )
+            m_ok = false;
+
+        if( node->m_type == wxT('C') )
+        {
+            if( node->m_alignment != IFM_ALIGN_HORIZONTAL && node->m_alignment != IFM_ALIGN_VERTICAL )
+                m_ok = false;
+            if( parent == wxT('C') && node->m_orientation != IFM_ORIENTATION_DOCKED )
+                m_ok = false;
+        }
+
+        for( int i = 0; i < count && m_ok; ++i )
+            node->m_children.Add(ReadNode(depth + 1, node->m_type));
+
+        return node;
+    }
+};
+
+static void SaveLayoutComponent(wxString &layout, wxIFMComponent *component)
+{
+    int type = component->GetType();
+    const wxIFMComponentArray &children = component->m_children;
+
+    if( type == IFM_COMPONENT_CONTAINER )
+    {
+        wxIFMContainerData *data = IFM_GET_EXTENSION_DATA(component, wxIFMContainerData);
+
+        layout << wxString::Format(wxT(" C %d %d %d %d %d"), data->m_orientation, component->m_alignment,
+            component->m_desiredSize.x, component->m_desiredSize.y, (int)children.GetCount());
+    }
+    else if( type == IFM_COMPONENT_PANEL )
+    {
+        wxIFMPanelData *data = IFM_GET_EXTENSION_DATA(component, wxIFMPanelData);
+
+        int selected = 0;
+        for( size_t i = 0; i < children.GetCount(); ++i )
+        {
+            if( data->m_active_tab && data->m_active_tab->m_tab == children[i] )
+                selected = i;
+        }
+
+        layout << wxString::Format(wxT(" P %d %d %d %d"), component->m_desiredSize.x,
+            component->m_desiredSize.y, selected, (int)children.GetCount());
+    }
+    else if( type == IFM_COMPONENT_PANEL_TAB )
+    {
+        layout << wxString::Format(wxT(" T %d %d %d %d:"), component->m_hidden ? 1 : 0,
+            component->m_desiredSize.x, component->m_desiredSize.y, (int)component->m_name.Length());
+        layout << component->m_name;
+        return;
+    }
+    else
+    {
+        layout << wxT(" X");
+        return;
+    }
+
+    for( size_t i = 0; i < children.GetCount(); ++i )
+        SaveLayoutComponent(layout, children[i]);
+}
+
+/*
+    Adds the tabs below the given component to the name map
+*/
+static void FindLayoutTabs(wxIFMComponent *component, wxIFMLayoutTabMap &tabs)
+{
+    if( component->GetType() == IFM_COMPONENT_PANEL_TAB )
+    {
+        // keep the first tab if several have the same name
+        if( tabs.find(component->m_name) == tabs.end() )
+            tabs[component->m_name] = component;
+        return;
+    }
+
+    const wxIFMComponentArray &children = component->m_children;
+    for( size_t i = 0; i < children.GetCount(); ++i )
+        FindLayoutTabs(children[i], tabs);
+}
+
+/*
+    Undocks the tabs mentioned by the layout, which deletes the panels and containers they leave empty
+*/
+static void UndockLayoutTabs(wxIFMInterfacePluginBase *ip, wxIFMLayoutNode *node, wxIFMLayoutTabMap &tabs)
+{
+    if( node->m_type == wxT('T') )
+    {
+        wxIFMLayoutTabMap::iterator i = tabs.find(node->m_name);
+        if( i != tabs.end() && i->second->m_docked )
+        {
+            wxIFMUndockEvent evt(i->second);
+            ip->ProcessPluginEvent(evt);
+        }
+        return;
+    }
+
+    // BuildLayoutComponent skips other types, leave their tabs where they are
+    if( node->m_type != wxT('C') && node->m_type != wxT('P') )
+        return;
+
+    for( size_t i = 0; i < node->m_children.GetCount(); ++i )
+        UndockLayoutTabs(ip, node->m_children[i], tabs);
+}
+
+/*
+    Creates the component described by the node and docks its children into it. The component
+    is returned undocked, or NULL if none of the tabs below it exist.
+*/
+static wxIFMComponent *BuildLayoutComponent(wxIFMInterfacePluginBase *ip, wxIFMLayoutNode *node, wxIFMLayoutTabMap &tabs)
+{
+    if( node->m_type == wxT('T') )
+    {
+        wxIFMLayoutTabMap::iterator i = tabs.find(node->m_name);
+        if( i == tabs.end() )
+            return NULL;
+
+        // each tab can only be placed once
+        wxIFMComponent *tab = i->second;
+        tabs.erase(i);
+
+        if( !tab->m_fixed )
+            tab->m_desiredSize = node->m_desiredSize;
+
+        node->m_component = tab;
+        return tab;
+    }
+
+    int type;
+    if( node->m_type == wxT('C') )
+        type = IFM_COMPONENT_CONTAINER;
+    else if( node->m_type == wxT('P') )
+        type = IFM_COMPONENT_PANEL;
+    else
+        return NULL;
+
+    wxIFMNewComponentEvent newevt(type);
+    ip->ProcessPluginEvent(newevt);
+
+    wxIFMComponent *component = newevt.GetComponent();
+    wxASSERT_MSG(component, wxT("NULL component returned by new component event?"));
+    if( !component )
+        return NULL;
+
+    wxIFMComponent *selected = NULL;
+    for( size_t i = 0; i < node->m_children.GetCount(); ++i )
+    {
+        wxIFMComponent *child = BuildLayoutComponent(ip, node->m_children[i], tabs);
+        if( !child )
+            continue;
+
+        wxIFMDockEvent dockevt(child, component, IFM_DEFAULT_INDEX);
+        ip->ProcessPluginEvent(dockevt);
+
+        if( (int)i == node->m_selected )
+            selected = child;
+    }
+
+    if( component->m_children.GetCount() == 0 )
+    {
+        wxIFMDeleteComponentEvent delevt(component);
+        ip->ProcessPluginEvent(delevt);
+        return NULL;
+    }
+
+    if( type == IFM_COMPONENT_CONTAINER )
+    {
+        wxIFMContainerData *data = IFM_GET_EXTENSION_DATA(component, wxIFMContainerData);
+        data->m_orientation = node->m_orientation;
+        component->m_alignment = node->m_alignment;
+    }
+    else if( selected )
+    {
+        wxIFMPanelData *data = IFM_GET_EXTENSION_DATA(component, wxIFMPanelData);
+        for( size_t i = 0; i < data->m_tabs.GetCount(); ++i )
+        {
+            if( data->m_tabs[i]->m_tab == selected )
+            {
+                wxIFMSelectTabEvent evt(component, data->m_tabs[i], false);
+                ip->ProcessPluginEvent(evt);
+                break;
+            }
+        }
+    }
+
+    // docking the first child sets a desired size, use the saved one instead
+    component->m_desiredSize = node->m_desiredSize;
+
+    node->m_component = component;
+    return component;
+}
+
+/*
+    Shows or hides the tabs placed by BuildLayoutComponent once the whole tree is built
+*/
+static void ShowLayoutTabs(wxIFMLayoutNode *node)
+{
+    if( node->m_type == wxT('T') )
+    {
+        if( node->m_component )
+            node->m_component->Show(!node->m_hidden, false);
+        return;
+    }
+
+    for( size_t i = 0; i < node->m_children.GetCount(); ++i )
+        ShowLayoutTabs(node->m_children[i]);
+}
+
+void wxIFMDefaultInterfacePlugin::OnSaveLayout(wxIFMLayoutEvent &event)
+{
+    wxString layout = wxString::Format(wxT("IFM %d"), IFM_LAYOUT_VERSION);
+
+    const wxIFMComponentArray &containers = GetTopContainers();
+    layout << wxString::Format(wxT(" %d"), (int)containers.GetCount());
+    for( size_t i = 0; i < containers.GetCount(); ++i )
+        SaveLayoutComponent(layout, containers[i]);
+
+#if IFM_CANFLOAT
+    // windows waiting to be destroyed have nothing left in them
+    int count = 0;
+    for( size_t i = 0; i < m_floatingWindows.GetCount(); ++i )
+    {
+        if( m_floatingWindows[i]->GetComponent()->m_children.GetCount() )
+            count++;
+    }
+
+    layout << wxString::Format(wxT(" %d"), count);
+    for( size_t i = 0; i < m_floatingWindows.GetCount(); ++i )
+    {
+        wxIFMFloatingWindowBase *base = m_floatingWindows[i];
+        if( !base->GetComponent()->m_children.GetCount() )
+            continue;
+
+        wxRect rect = base->GetWindow()->GetRect();
+        layout << wxString::Format(wxT(" %d %d %d %d"), rect.x, rect.y, rect.width, rect.height);
+        SaveLayoutComponent(layout, base->GetComponent());
+    }
+#else
+    layout << wxT(" 0");
+#endif
+
+    event.SetLayout(layout);
+    event.SetSuccess();
+}
+
+void wxIFMDefaultInterfacePlugin::OnLoadLayout(wxIFMLayoutEvent &event)
+{
+    wxIFMLayoutNodeArray top, floating;
+    size_t i;
+
+    // read the whole layout before changing anything
+    {
+        wxIFMLayoutReader reader(event.GetLayout());
+
+        if( reader.ReadChar() != wxT('I') || reader.ReadChar() != wxT('F') || reader.ReadChar() != wxT('M') ||
+            reader.ReadInt() != IFM_LAYOUT_VERSION )
+            return;
+
+        int count = reader.ReadInt();
+        for( int n = 0; n < count && reader.IsOk(); ++n )
+        {
+            wxIFMLayoutNode *node = reader.ReadNode(0);
+            top.Add(node);
+
+            if( node->m_type != wxT('C') || node->m_orientation < IFM_ORIENTATION_TOP ||
+                node->m_orientation > IFM_ORIENTATION_RIGHT )
+                reader.Fail();
+        }
+
+        count = reader.ReadInt();
+        for( int n = 0; n < count && reader.IsOk(); ++n )
+        {
+            wxRect rect;
+            rect.x = reader.ReadInt();
+            rect.y = reader.ReadInt();
+            rect.width = reader.ReadInt();
+            rect.height = reader.ReadInt();
+
+            wxIFMLayoutNode *node = reader.ReadNode(0);
+            node->m_rect = rect;
+            floating.Add(node);
+
+            if( node->m_type != wxT('C') || node->m_orientation != IFM_ORIENTATION_FLOAT )
+                reader.Fail();
+        }
+
+        if( !reader.IsOk() )
+        {
+            for( i = 0; i < top.GetCount(); ++i )
+                delete top[i];
+            for( i = 0; i < floating.GetCount(); ++i )
+                delete floating[i];
+            return;
+        }
+    }
+
+    // find the existing tabs by name
+    wxIFMLayoutTabMap tabs;
+    for( i = 0; i < m_topContainers.GetCount(); ++i )
+        FindLayoutTabs(m_topContainers[i], tabs);
+#if IFM_CANFLOAT
+    for( i = 0; i < m_floatingWindows.GetCount(); ++i )
+        FindLayoutTabs(m_floatingWindows[i]->GetComponent(), tabs);
+#endif
+
+    BeginBulkUpdate();
+
+    // take the tabs the layout places out of the interface
+    for( i = 0; i < top.GetCount(); ++i )
+        UndockLayoutTabs(this, top[i], tabs);
+    for( i = 0; i < floating.GetCount(); ++i )
+        UndockLayoutTabs(this, floating[i], tabs);
+
+    // build the saved components around them
+    for( i = 0; i < top.GetCount(); ++i )
+    {
+        wxIFMComponent *container = BuildLayoutComponent(this, top[i], tabs);
+        if( container )
+        {
+            wxIFMAddTopContainerEvent addevt(container, -1);
+            ProcessPluginEvent(addevt);
+        }
+    }
+
+    for( i = 0; i < floating.GetCount(); ++i )
+    {
+        wxIFMLayoutNode *node = floating[i];
+        wxIFMComponent *root = BuildLayoutComponent(this, node, tabs);
+        if( !root )
+            continue;
+
+#if IFM_CANFLOAT
+        // a floated container becomes the root component of its floating window
+        wxIFMFloatEvent floatevt(root, node->m_rect.GetPosition(), root->m_desiredSize);
+        ProcessPluginEvent(floatevt);
+
+        wxIFMFloatingData *floating_data = IFM_GET_EXTENSION_DATA(root, wxIFMFloatingData);
+        wxASSERT_MSG(floating_data && floating_data->m_window, wxT("Floating a layout container failed?"));
+        if( floating_data && floating_data->m_window )
+            floating_data->m_window->GetWindow()->SetSize(node->m_rect);
+#else
+        // dock floating components on the left without floating support
+        root->m_alignment = IFM_ALIGN_VERTICAL;
+        IFM_GET_EXTENSION_DATA(root, wxIFMContainerData)->m_orientation = IFM_ORIENTATION_LEFT;
+
+        wxIFMAddTopContainerEvent addevt(root, -1);
+        ProcessPluginEvent(addevt);
+#endif
+    }
+
+    for( i = 0; i < top.GetCount(); ++i )
+    {
+        ShowLayoutTabs(top[i]);
+        delete top[i];
+    }
+    for( i = 0; i < floating.GetCount(); ++i )
+    {
+        ShowLayoutTabs(floating[i]);
+        delete floating[i];
+    }
+
+    EndBulkUpdate();
+
+    InvalidateDisplayLists();
+
+    event.SetSuccess();
+}
+
 void wxIFMDefaultInterfacePlugin::OnUpdate(wxIFMUpdateEvent &event)
 {
     wxSize size = event.GetSize();
@@ -500,9 +1222,9 @@ void wxIFMDefaultInterfacePlugin::OnUpdate(wxIFMUpdateEvent &event)
 
     // update containers beginning from the start of the list
     // also calculate the minimum allowable size for the interface
-    for( wxIFMComponentList::iterator i = m_containers.begin(), end = m_containers.end(); i != end; ++i )
+    for( size_t i = 0, count = m_topContainers.GetCount(); i < count; ++i )
     {
-        container = *i;
+        container = m_topContainers[i];
 
         if( !container->IsVisible() )
             continue;
@@ -513,9 +1235,7 @@ void wxIFMDefaultInterfacePlugin::OnUpdate(wxIFMUpdateEvent &event)
         wxSize size = container->GetDesiredSize();
         wxSize min_size = container->GetMinSize();
 
-        wxIFMComponentList::iterator temp = i;
-        ++temp;
-        if( temp == end && !content )
+        if( i + 1 == count && !content )
         {
             // make this container as big as the remaining area to deal with having no content window
             rect = m_contentRect;
@@ -647,24 +1367,51 @@ void wxIFMDefaultInterfacePlugin::OnPaint(wxIFMPaintInterfaceEvent &event)
     wxIFMComponent *component;
     wxRegionContain result;
 
-    // don't paint a component if we don't have to
     const wxRegion &region = event.GetUpdateRegion();
-    for( wxIFMComponentList::const_iterator i = m_containers.begin(), end = m_containers.end(); i != end; ++i )
+
+    // replay the recorded interface instead of sending paint events to each component
+    if( GetManager()->GetFlags() & IFM_DISPLAY_LIST )
     {
-        component = *i;
+        if( m_displayListDirty )
+        {
+            m_displayList.Clear();
+            for( size_t i = 0, count = m_topContainers.GetCount(); i < count; ++i )
+            {
+                component = m_topContainers[i];
+                if( component->IsVisible() )
+                    component->BuildDisplayList(m_displayList);
+            }
+            m_displayListDirty = false;
+        }
+
+        m_displayList.Replay(dc, region);
+        return;
+    }
+
+    // clip once for the whole paint, components don't clip individually
+    dc.DestroyClippingRegion();
+    dc.SetClippingRegion(region);
+
+    // don't paint a component if we don't have to
+    for( size_t i = 0, count = m_topContainers.GetCount(); i < count; ++i )
+    {
+        component = m_topContainers[i];
 
         if( !component->IsVisible() )
             continue;
         else
         {
-            result = region.Contains(component->m_rect);
-            if( result == wxInRegion || result == wxPartRegion )
+            const wxRect &bounds = component->GetBounds();
+            result = region.Contains(bounds);
+            if( result == wxInRegion )
+                component->Paint(dc, wxRegion(bounds));
+            else if( result == wxPartRegion )
             {
                 // make a copy of the region and find the parts of the component
                 // that need updating
-                //wxRegion new_region = region;
-                //new_region.Intersect(component->m_rect);
-                component->Paint(dc, region);
+                wxRegion new_region = region;
+                new_region.Intersect(bounds);
+                component->Paint(dc, new_region);
             }
         }
     }
@@ -689,9 +1436,9 @@ wxIFMComponent *wxIFMDefaultInterfacePlugin::GetComponentByPos(const wxPoint &po
     if( component == NULL )
     {
         wxIFMComponent *ret;
-        for( wxIFMComponentList::const_iterator i = m_containers.begin(), end = m_containers.end(); i != end; ++i )
+        for( size_t i = 0, count = m_topContainers.GetCount(); i < count; ++i )
         {
-            ret = GetComponentByPos(pos, *i);
+            ret = GetComponentByPos(pos, m_topContainers[i]);
             if( ret )
                 return ret;
         }
@@ -727,9 +1474,9 @@ void wxIFMDefaultInterfacePlugin::OnGetContentRect(wxIFMRectEvent &event)
     wxIFMContainerData *data;
 
     // update containers beginning from the start of the list
-    for( wxIFMComponentList::const_iterator i = m_containers.begin(), end = m_containers.end(); i != end; ++i )
+    for( size_t i = 0, count = m_topContainers.GetCount(); i < count; ++i )
     {
-        container = *i;
+        container = m_topContainers[i];
         data = IFM_GET_EXTENSION_DATA(container, wxIFMContainerData);
 
         wxIFMRectEvent rectevt(wxEVT_IFM_GETRECT, container);
@@ -779,11 +1526,30 @@ void wxIFMDefaultInterfacePlugin::OnCreateFloatingWindow(wxIFMCreateFloatingWind
     if( !component )
         return;
 
-    // create a frame to float with
-    long style = IFM_FLOATING_FRAME_STYLE;
+    // create a frame to float with, using a pooled frame if one is available
+    wxIFMFloatingWindowBase *window = NULL;
+    for( int i = m_framePool.GetCount() - 1; i >= 0; --i )
+    {
+        wxFrame *frame = m_framePool[i];
+        if( frame->GetParent() == event.GetParent() )
+        {
+            m_framePool.RemoveAt(i);
+            window = new wxIFMFloatingFrame(this, frame);
+
+            // replace the frame once the user is done floating, not while the window appears
+            if( !m_framePoolTimer.IsRunning() )
+                m_framePoolTimer.Start(IFM_FLOATING_FRAME_POOL_DELAY, wxTIMER_ONE_SHOT);
+            break;
+        }
+    }
+
+    if( !window )
+    {
+        long style = IFM_FLOATING_FRAME_STYLE;
 
-    wxIFMFloatingWindowBase *window = new wxIFMFloatingFrame(this, event.GetParent(), wxID_ANY, wxT(""),
-        wxPoint(0,0), wxSize(0,0), style);
+        window = new wxIFMFloatingFrame(this, event.GetParent(), wxID_ANY, wxT(""),
+            wxPoint(0,0), wxSize(0,0), style);
+    }
     event.SetWindow(window);
 
     // create the root component as well
@@ -843,7 +1609,41 @@ void wxIFMDefaultInterfacePlugin::OnDestroyFloatingWindow(wxIFMDestroyFloatingWi
 
     base->m_destroyRoot = event.ShouldDestroyRoot();
 
+    // keep the frame for the next floating window if there is room in the pool
+    wxFrame *frame = NULL;
+    if( (int)m_framePool.GetCount() < m_framePoolSize && wxDynamicCast(base->GetWindow(), wxFrame) )
+        frame = wxStaticCast(base->DetachWindow(), wxFrame);
+
+    bool keep_root = !base->m_destroyRoot;
     delete base;
+
+    if( frame )
+    {
+        // deleting components leaves their child windows and buttons on the frame. Destroy
+        // them like destroying the frame would have, unless the root component and its
+        // windows live on, in which case they go back to the managed window.
+        wxWindowList::compatibility_iterator node = frame->GetChildren().GetFirst();
+        while( node )
+        {
+            wxWindow *child = node->GetData();
+            node = node->GetNext();
+
+            if( keep_root )
+                child->Reparent(GetManager()->GetParent());
+            else
+                child->Destroy();
+        }
+
+        // frames still owning child windows can't be handed out again
+        if( frame->GetChildren().GetCount() == 0 )
+        {
+            frame->Hide();
+            frame->SetTitle(wxT(""));
+            m_framePool.push_back(frame);
+        }
+        else
+            frame->Destroy();
+    }
 }
 
 #endif
@@ -861,6 +1661,7 @@ BEGIN_EVENT_TABLE(wxIFMDefaultContainerPlugin, wxIFMExtensionPluginBase)
     EVT_IFM_SETDESIREDSIZE  (wxIFMDefaultContainerPlugin::OnSetDesiredSize)
     EVT_IFM_LEFTDOWN        (wxIFMDefaultContainerPlugin::OnLeftDown)
     EVT_IFM_PAINTDECOR      (wxIFMDefaultContainerPlugin::OnPaintDecor)
+    EVT_IFM_BUILDDISPLAYLIST (wxIFMDefaultContainerPlugin::OnBuildDisplayList)
 
     EVT_IFM_COMPONENTBUTTONCLICK (wxIFMDefaultContainerPlugin::OnComponentButtonClick)
 
@@ -875,56 +1676,13 @@ wxIFMDefaultContainerPlugin::wxIFMDefaultContainerPlugin()
 
 bool wxIFMDefaultContainerPlugin::HasVisibleChildren(wxIFMComponent *component)
 {
-    wxIFMComponentArray &children = component->m_children;
-    wxIFMComponent *child;
-
-    for( int i = 0, size = children.GetCount(); i < size; ++i )
-    //for( wxIFMComponentArray::const_iterator i = children.begin(), end = children.end(); i != end; ++i )
-    {
-        child = children[i];
-        //child = *i;
-
-        // child containers alone don't count, but their children do
-        if( child->GetType() == IFM_COMPONENT_CONTAINER )
-        {
-            if( HasVisibleChildren(child) )
-                return true;
-        }
-        else
-        {
-            if( child->IsVisible() )
-                return true;
-        }
-    }
-
-    return false;
+    // child containers alone don't count, but their children do
+    return component->GetVisibleLeafCount() > 0;
 }
 
 int wxIFMDefaultContainerPlugin::GetVisibleChildrenCount(wxIFMComponent *component)
 {
-    wxIFMComponentArray &children = component->m_children;
-    wxIFMComponent *child;
-    int child_count = 0;
-
-    for( int i = 0, size = children.GetCount(); i < size; ++i )
-    //for( wxIFMComponentArray::const_iterator i = children.begin(), end = children.end(); i != end; ++i )
-    {
-        child = children[i];
-        //child = *i;
-
-        // child containers alone don't count, but their children do
-        if( child->GetType() == IFM_COMPONENT_CONTAINER )
-        {
-            child_count += GetVisibleChildrenCount(child);
-        }
-        else
-        {
-            if( child->IsVisible() )
-                child_count++;
-        }
-    }
-
-    return child_count;
+    return component->GetVisibleLeafCount();
 }
 
 bool wxIFMDefaultContainerPlugin::HasNonCloseableChildren(wxIFMComponent *component)
@@ -1014,6 +1772,32 @@ void wxIFMDefaultContainerPlugin::OnPaintDecor(wxIFMPaintEvent &event)
         event.Skip();
 }
 
+// record the drag gripper, same as OnPaintDecor
+void wxIFMDefaultContainerPlugin::OnBuildDisplayList(wxIFMDisplayListEvent &event)
+{
+#if IFM_CONTAINER_GRIPPER_WIDTH
+    if( event.GetComponentType() == IFM_COMPONENT_CONTAINER && event.GetPhase() == IFM_DISPLAY_DECORATIONS )
+    {
+        wxIFMComponent *component = event.GetComponent();
+
+        wxASSERT_MSG(component, wxT("NULL component?"));
+        if( !component )
+            return;
+
+        wxIFMContainerData *data = IFM_GET_EXTENSION_DATA(component, wxIFMContainerData);
+
+        wxASSERT_MSG(data, wxT("Container with no container data?"));
+        if( !data )
+            return;
+
+        event.GetDisplayList().AddRectangle(data->m_tray_rect, *wxBLACK_PEN,
+            wxBrush(wxSystemSettings::GetColour(wxSYS_COLOUR_BTNSHADOW)));
+    }
+    else
+#endif
+        event.Skip();
+}
+
 void wxIFMDefaultContainerPlugin::OnSetDesiredSize(wxIFMRectEvent &event)
 {
     if( event.GetComponentType() != IFM_COMPONENT_CONTAINER )
@@ -1563,6 +2347,7 @@ BEGIN_EVENT_TABLE(wxIFMDefaultPanelPlugin, wxIFMExtensionPluginBase)
     EVT_IFM_SHOWCOMPONENT   (wxIFMDefaultPanelPlugin::OnShowComponent)
     EVT_IFM_PAINTDECOR      (wxIFMDefaultPanelPlugin::OnPaintDecor)
     EVT_IFM_PAINTBG         (wxIFMDefaultPanelPlugin::OnPaintBg)
+    EVT_IFM_BUILDDISPLAYLIST (wxIFMDefaultPanelPlugin::OnBuildDisplayList)
     EVT_IFM_DOCK            (wxIFMDefaultPanelPlugin::OnDock)
     EVT_IFM_UNDOCK          (wxIFMDefaultPanelPlugin::OnUndock)
     EVT_IFM_COMPONENTBUTTONCLICK (wxIFMDefaultPanelPlugin::OnComponentButtonClick)
@@ -1583,6 +2368,7 @@ END_EVENT_TABLE()
 
 wxIFMCaptionConfig wxIFMDefaultPanelPlugin::m_caption_config;
 wxIFMTabConfig wxIFMDefaultPanelPlugin::m_tab_config;
+wxIFMTextExtentCache wxIFMDefaultPanelPlugin::m_text_extents;
 bool wxIFMDefaultPanelPlugin::init_config = true;
 
 wxIFMCaptionConfig &wxIFMDefaultPanelPlugin::GetCaptionConfig()
@@ -1595,6 +2381,11 @@ wxIFMTabConfig &wxIFMDefaultPanelPlugin::GetTabConfig()
     return m_tab_config;
 }
 
+wxIFMTextExtentCache &wxIFMDefaultPanelPlugin::GetTextExtentCache()
+{
+    return m_text_extents;
+}
+
 wxIFMDefaultPanelPlugin::wxIFMDefaultPanelPlugin()
 : wxIFMExtensionPluginBase()
 {
@@ -1872,8 +2663,7 @@ void wxIFMDefaultPanelPlugin::OnDock(wxIFMDockEvent &event)
         tab->m_tab = panel_tab;
 
         // calculate the width of the tabs name string
-        int h;
-        GetManager()->GetParent()->GetTextExtent(tab->m_tab->m_name, &tab->m_name_width, &h, 0, 0, &m_tab_config.m_font);
+        tab->m_name_width = m_text_extents.GetTextExtent(tab->m_tab->m_name, m_tab_config.m_font, GetManager()->GetParent()).GetWidth();
         if( tab->m_name_width == 0 )
             tab->m_name_width = 20;
 
@@ -1889,6 +2679,7 @@ void wxIFMDefaultPanelPlugin::OnDock(wxIFMDockEvent &event)
         }
 
         panel_tab->m_parent = panel;
+        wxIFMComponent::InvalidateTreeLabels();
 
         // generate a name for this panel so that docking panels as tabs doesn't yield a blank tab
         wxString name;
@@ -1973,6 +2764,7 @@ void wxIFMDefaultPanelPlugin::OnUndock(wxIFMUndockEvent &event)
             data->m_active_tab = NULL;
 
         delete tab;
+        data->InvalidateDecorations();
 
         // default processing
         GetNextHandler()->ProcessEvent(event);
@@ -2003,12 +2795,14 @@ void wxIFMDefaultPanelPlugin::UpdateTabs(wxIFMComponent *panel)
         if( !data )
             return;
 
+        data->InvalidateDecorations();
+
         for( unsigned int i = 0; i < data->m_tabs.size(); ++i )
         {
             wxIFMTab *tab = data->m_tabs[i];
 
             // calculate the width of the tabs name string
-            GetManager()->GetParent()->GetTextExtent(tab->m_tab->m_name, &tab->m_name_width, 0, 0, 0, &m_tab_config.m_font);
+            tab->m_name_width = m_text_extents.GetTextExtent(tab->m_tab->m_name, m_tab_config.m_font, GetManager()->GetParent()).GetWidth();
             if( tab->m_name_width == 0 )
                 tab->m_name_width = 20;
         }
@@ -2077,6 +2871,9 @@ void wxIFMDefaultPanelPlugin::OnUpdate(wxIFMUpdateComponentEvent &event)
         if( !data->m_active_tab )
             return;
 
+        // tab and caption rects are about to be recalculated
+        data->InvalidateDecorations();
+
         // forward the update event to the active panel but size ourself first
         GetNextHandler()->ProcessEvent(event);
 
@@ -2166,6 +2963,7 @@ void wxIFMDefaultPanelPlugin::OnShowComponent(wxIFMShowComponentEvent &event)
         }
 
         tab->m_visible = show;
+        data->InvalidateDecorations();
 
         if( !show )
         {
@@ -2311,16 +3109,41 @@ void wxIFMDefaultPanelPlugin::OnPaintDecor(wxIFMPaintEvent &event)
             return;
 
         wxDC &dc = event.GetDC();
-        wxRegionContain result = region.Contains(data->m_caption);
-        if( result == wxPartRegion || result == wxInRegion )
+        wxString caption = (data->m_active_tab) ? data->m_active_tab->m_tab->m_name : wxString(wxT(""));
+
+        // in retained mode, render the caption and tabs once and blit them until they change
+        if( GetManager()->GetFlags() & IFM_RETAINED_DECORATIONS )
         {
-            // draw caption
-            DrawCaption(dc, data->m_caption, (data->m_active_tab) ? data->m_active_tab->m_tab->m_name : wxT(""),
-                IFM_ORIENTATION_TOP);
+            if( !data->m_caption_cache.IsValid(data->m_caption) )
+            {
+                wxMemoryDC mdc;
+                if( data->m_caption_cache.BeginRender(mdc, data->m_caption) )
+                {
+                    DrawCaption(mdc, data->m_caption, caption, IFM_ORIENTATION_TOP);
+                    data->m_caption_cache.EndRender(mdc);
+                }
+            }
+
+            data->m_caption_cache.Blit(dc, region);
+
+            if( ShouldDrawTabs(data->m_tabs) )
+            {
+                UpdateTabsCache(component, data);
+                data->m_tabs_cache.Blit(dc, region);
+            }
         }
+        else
+        {
+            wxRegionContain result = region.Contains(data->m_caption);
+            if( result == wxPartRegion || result == wxInRegion )
+            {
+                // draw caption
+                DrawCaption(dc, data->m_caption, caption, IFM_ORIENTATION_TOP);
+            }
 
-        if( ShouldDrawTabs(data->m_tabs) )
-            DrawTabs(dc, component, region, data->m_tabs);
+            if( ShouldDrawTabs(data->m_tabs) )
+                DrawTabs(dc, component, region, data->m_tabs);
+        }
     }
     else
         event.Skip();
@@ -2381,17 +3204,105 @@ void wxIFMDefaultPanelPlugin::OnPaintBg(wxIFMPaintEvent &event)
         event.Skip();
 }
 
-void wxIFMDefaultPanelPlugin::DrawTabs(wxDC &dc, wxIFMComponent *component, const wxRegion &region, const wxIFMTabArray &tabs)
+void wxIFMDefaultPanelPlugin::UpdateTabsCache(wxIFMComponent *panel, wxIFMPanelData *data)
 {
-    wxIFMTab *tab;
+    wxRect tabs_area = GetTabRowRect(panel);
+
+    // the top line of the tab row extends one pixel past each side
+    tabs_area.Inflate(1, 0);
+
+    if( data->m_tabs_cache.IsValid(tabs_area) )
+        return;
+
+    wxMemoryDC mdc;
+    if( data->m_tabs_cache.BeginRender(mdc, tabs_area) )
+    {
+        // the extra columns are otherwise covered by the panel background
+        mdc.SetBrush(m_tab_config.m_tab_active_bg_b);
+        mdc.SetPen(wxPen(m_tab_config.m_tab_active_bg_b.GetColour()));
+        mdc.DrawRectangle(tabs_area);
+
+        DrawTabs(mdc, panel, wxRegion(tabs_area), data->m_tabs);
+        data->m_tabs_cache.EndRender(mdc);
+    }
+}
+
+void wxIFMDefaultPanelPlugin::OnBuildDisplayList(wxIFMDisplayListEvent &event)
+{
+    int type = event.GetComponentType();
+    if( !(type == IFM_COMPONENT_PANEL || (type == IFM_COMPONENT_PANEL_TAB && event.GetPhase() == IFM_DISPLAY_BACKGROUND)) )
+    {
+        event.Skip();
+        return;
+    }
+
+    wxIFMComponent *component = event.GetComponent();
+
+    wxASSERT_MSG(component, wxT("NULL component?"));
+    if( !component )
+        return;
+
+    if( component->m_hidden )
+        return;
+
+    wxIFMDisplayList &list = event.GetDisplayList();
+
+    switch( event.GetPhase() )
+    {
+    case IFM_DISPLAY_BACKGROUND:
+        // same as OnPaintBg
+        list.AddRectangle(component->GetBackgroundRect(),
+            wxPen(m_tab_config.m_tab_active_bg_b.GetColour()), m_tab_config.m_tab_active_bg_b);
+        break;
+
+    case IFM_DISPLAY_DECORATIONS:
+    {
+        wxIFMPanelData *data = IFM_GET_EXTENSION_DATA(component, wxIFMPanelData);
+
+        wxASSERT_MSG(data, wxT("Panel with no panel data?"));
+        if( !data )
+            return;
+
+        RecordCaption(list, data->m_caption,
+            (data->m_active_tab) ? data->m_active_tab->m_tab->m_name : wxString(wxT("")), IFM_ORIENTATION_TOP);
+
+        // the tab row is made of many small shapes, record it as one cached bitmap instead
+        if( ShouldDrawTabs(data->m_tabs) )
+        {
+            UpdateTabsCache(component, data);
+
+            if( data->m_tabs_cache.IsValid(data->m_tabs_cache.GetRect()) )
+            {
+                const wxRect &rect = data->m_tabs_cache.GetRect();
+                list.AddBitmap(data->m_tabs_cache.GetBitmap(), rect.x, rect.y);
+            }
+        }
+        break;
+    }
+
+    default:
+        event.Skip();
+    }
+}
 
-    wxRect bg = component->GetClientRect();
+wxRect wxIFMDefaultPanelPlugin::GetTabRowRect(wxIFMComponent *panel)
+{
+    wxRect bg = panel->GetClientRect();
     wxRect tabs_area;
     tabs_area.x = bg.x;
     tabs_area.y = bg.y + bg.height + 1;// - 1;//tab->m_tab->m_parent->m_margins.bottom;
     tabs_area.width = bg.width;
     tabs_area.height = m_tab_config.m_row_height;
 
+    return tabs_area;
+}
+
+void wxIFMDefaultPanelPlugin::DrawTabs(wxDC &dc, wxIFMComponent *component, const wxRegion &region, const wxIFMTabArray &tabs)
+{
+    wxIFMTab *tab;
+
+    wxRect tabs_area = GetTabRowRect(component);
+
     // paint tabs only if we need to
     wxRegionContain result = region.Contains(tabs_area);
     if( !(result == wxInRegion || result == wxPartRegion) )
@@ -2475,80 +3386,47 @@ void wxIFMDefaultPanelPlugin::DrawTabs(wxDC &dc, wxIFMComponent *component, cons
     }
 }
 
-void DrawVerticalGradient(wxDC &dc, const wxRect &rect, wxColour color1, wxColour color2)
-{
-	// gradient fill from colour 1 to colour 2 with top to bottom
-
-	if(rect.height < 1 || rect.width < 1)
-		return;
-
-	int size = rect.height;
-
-	dc.SetPen(*wxTRANSPARENT_PEN);
-
-	if (color1 == color2)
-	{
-		dc.SetBrush(wxBrush(color1, wxSOLID));
-		dc.DrawRectangle(rect);
-		return;
-	}
-
-
-	// calculate gradient coefficients
-	double rstep = double((color2.Red() -   color1.Red())) / double(size), rf = 0,
-	gstep = double((color2.Green() - color1.Green())) / double(size), gf = 0,
-	bstep = double((color2.Blue() -  color1.Blue())) / double(size), bf = 0;
-
-	wxColour currCol;
-	for(int y = rect.y; y < rect.y + size; y++)
-	{
-		currCol.Set(
-		(unsigned char)(color1.Red() + rf),
-		(unsigned char)(color1.Green() + gf),
-		(unsigned char)(color1.Blue() + bf)
-		);
-		dc.SetBrush( wxBrush( currCol, wxSOLID ) );
-		dc.DrawRectangle( rect.x, rect.y + (y - rect.y), rect.width, size );
-		//currCol.Set(currCol.Red() + rstep, currCol.Green() + gstep, currCol.Blue() + bstep);
-		rf += rstep; gf += gstep; bf += bstep;
-	}
-}
-
-void DrawHorizontalGradient(wxDC &dc, const wxRect &rect, wxColour color1, wxColour color2)
+void wxIFMDefaultPanelPlugin::RecordCaption(wxIFMDisplayList &list, const wxRect &rect, const wxString &caption, int orientation)
 {
-	// gradient fill from colour 1 to colour 2 with left to right
-
-	if(rect.height < 1 || rect.width < 1)
-		return;
-
-	int size = rect.width;
-
-	dc.SetPen(*wxTRANSPARENT_PEN);
+    // this must stay in sync with DrawCaption
+    switch(m_caption_config.m_style & IFM_CAPTION_MASK)
+    {
+    case IFM_CAPTION_GRADIENT:
+        switch (orientation)
+        {
+        default:
+            wxASSERT(false);
+            break;
+        case IFM_ORIENTATION_TOP:
+        case IFM_ORIENTATION_BOTTOM:
+            list.AddGradient(rect, m_caption_config.m_caption_color, m_caption_config.m_gradient_color, wxHORIZONTAL);
+            break;
+        case IFM_ORIENTATION_LEFT:
+            list.AddGradient(rect, m_caption_config.m_gradient_color, m_caption_config.m_caption_color, wxVERTICAL);
+            break;
+        case IFM_ORIENTATION_RIGHT:
+            list.AddGradient(rect, m_caption_config.m_caption_color, m_caption_config.m_gradient_color, wxVERTICAL);
+            break;
+        }
+        break;
 
-	if (color1 == color2)
-	{
-		dc.SetBrush(wxBrush(color1, wxSOLID));
-		dc.DrawRectangle(rect);
-		return;
-	}
+    case IFM_CAPTION_SOLID:
+    default:
+        list.AddRectangle(rect, wxPen(m_caption_config.m_caption_color), wxBrush(m_caption_config.m_caption_color));
+    }
 
-	// calculate gradient coefficients
-	double rstep = double((color2.Red() -   color1.Red())) / double(size), rf = 0,
-	gstep = double((color2.Green() - color1.Green())) / double(size), gf = 0,
-	bstep = double((color2.Blue() -  color1.Blue())) / double(size), bf = 0;
+    int x, y;
 
-	wxColour currCol;
-	for(int x = rect.x; x < rect.x + size; x++)
-	{
-		currCol.Set(
-		(unsigned char)(color1.Red() + rf),
-		(unsigned char)(color1.Green() + gf),
-		(unsigned char)(color1.Blue() + bf)
-		);
-	    dc.SetBrush( wxBrush( currCol, wxSOLID ) );
-	    dc.DrawRectangle( rect.x + (x - rect.x), rect.y, 1, rect.height );
-	    rf += rstep; gf += gstep; bf += bstep;
+    switch(m_caption_config.m_style & IFM_CAPTION_TITLE_MASK)
+    {
+    case IFM_CAPTION_LEFT:
+    default:
+        x = rect.x + m_caption_config.m_padding;
+        y = rect.y + (m_caption_config.m_size - m_caption_config.m_font_height) / 2;
+        break;
     }
+
+    list.AddText(caption, x, y, m_caption_config.m_font, m_caption_config.m_font_color, rect);
 }
 
 void wxIFMDefaultPanelPlugin::DrawCaption(wxDC &dc, const wxRect &rect, const wxString &caption, int orientation) 
@@ -2567,13 +3445,13 @@ void wxIFMDefaultPanelPlugin::DrawCaption(wxDC &dc, const wxRect &rect, const wx
             break;
         case IFM_ORIENTATION_TOP:
         case IFM_ORIENTATION_BOTTOM:
-            DrawHorizontalGradient(dc, rect, m_caption_config.m_caption_color, m_caption_config.m_gradient_color);
+            wxIFMDisplayList::DrawGradient(dc, rect, m_caption_config.m_caption_color, m_caption_config.m_gradient_color, wxHORIZONTAL);
             break;
         case IFM_ORIENTATION_LEFT:
-            DrawVerticalGradient(dc, rect, m_caption_config.m_gradient_color, m_caption_config.m_caption_color);
+            wxIFMDisplayList::DrawGradient(dc, rect, m_caption_config.m_gradient_color, m_caption_config.m_caption_color, wxVERTICAL);
             break;
         case IFM_ORIENTATION_RIGHT:
-            DrawVerticalGradient(dc, rect, m_caption_config.m_caption_color, m_caption_config.m_gradient_color);
+            wxIFMDisplayList::DrawGradient(dc, rect, m_caption_config.m_caption_color, m_caption_config.m_gradient_color, wxVERTICAL);
             break;
         }
         break;
@@ -2750,14 +3628,9 @@ void wxIFMDefaultPanelPlugin::OnSelectTab(wxIFMSelectTabEvent &event)
             return;
 
         // record the new active tab
+        wxIFMTab *old_tab = data->m_active_tab;
         data->m_active_tab = tab;
-
-        // update the new tab
-        if( event.GetUpdate() )
-        {
-            wxIFMUpdateComponentEvent evt(tab->m_tab, panel->GetClientRect());
-            GetIP()->ProcessPluginEvent(evt);
-        }
+        data->InvalidateDecorations();
 
         // show and activate the new tab while hiding the others
         for( size_t i = 0; i < data->m_tabs.GetCount(); i++ )
@@ -2768,9 +3641,20 @@ void wxIFMDefaultPanelPlugin::OnSelectTab(wxIFMSelectTabEvent &event)
             data->m_tabs[i]->m_active = data->m_tabs[i] == tab;
         }
 
-        if(event.GetUpdate()) {
-            wxIFMUpdateComponentEvent evt(panel, panel->GetRect());
+        // tab positions don't depend on which tab is active, so only the new tab's
+        // client area, the caption and the two tabs that changed state need to be repainted
+        if( event.GetUpdate() )
+        {
+            wxIFMUpdateComponentEvent evt(tab->m_tab, panel->GetClientRect());
             GetIP()->ProcessPluginEvent(evt);
+
+            wxWindow *window = panel->GetParentWindow();
+            wxInterfaceManager *manager = GetManager();
+
+            manager->AddDamage(window, data->m_caption);
+            manager->AddDamage(window, tab->m_rect);
+            if( old_tab )
+                manager->AddDamage(window, old_tab->m_rect);
         }
     }
     else
@@ -3099,7 +3983,7 @@ void wxIFMComponentButton::SetHover(bool h)
     if( h != m_hover )
     {
         m_hover = h;
-        Refresh();
+        GetIP()->GetManager()->AddDamage(this, wxRect(wxPoint(0,0), GetClientSize()));
     }
 }
 
@@ -3108,7 +3992,7 @@ void wxIFMComponentButton::SetPressed(bool p)
     if( p != m_pressed )
     {
         m_pressed = p;
-        Refresh();
+        GetIP()->GetManager()->AddDamage(this, wxRect(wxPoint(0,0), GetClientSize()));
     }
 }
 
@@ -3186,6 +4070,113 @@ void wxIFMComponentButton::OnMouseMove(wxMouseEvent &event)
     }
 }
 
+/*
+    wxIFMHintWindow implementation
+*/
+BEGIN_EVENT_TABLE(wxIFMHintWindow, wxFrame)
+    EVT_ERASE_BACKGROUND (wxIFMHintWindow::OnEraseBackground)
+    EVT_PAINT           (wxIFMHintWindow::OnPaint)
+END_EVENT_TABLE()
+
+wxIFMHintWindow::wxIFMHintWindow(wxWindow *parent)
+    : wxFrame(parent, wxID_ANY, wxT(""), wxDefaultPosition, wxSize(1,1),
+        wxFRAME_NO_TASKBAR | wxFRAME_FLOAT_ON_PARENT | wxFRAME_SHAPED | wxNO_BORDER),
+    m_outline(false),
+    m_shaped(false)
+{
+#if wxCHECK_VERSION(2,8,0)
+    if( CanSetTransparent() )
+        SetTransparent(IFM_HINT_ALPHA);
+#endif
+}
+
+void wxIFMHintWindow::ShowHint(const wxRect &rect, bool outline)
+{
+    if( !IsShown() || outline != m_outline )
+    {
+        m_outline = outline;
+        MoveHint(rect);
+
+        // show the hint without taking focus away from the window being dragged
+#ifdef __WXMSW__
+        wxWindowBase::Show(true); // need this to keep wx happy
+        ::ShowWindow((HWND)GetHandle(), SW_SHOWNOACTIVATE);
+#else
+        Show();
+#endif
+        return;
+    }
+
+    if( rect != m_rect )
+        MoveHint(rect);
+}
+
+void wxIFMHintWindow::HideHint()
+{
+#ifdef __WXMSW__
+    wxWindowBase::Show(false);
+    ::ShowWindow((HWND)GetHandle(), SW_HIDE);
+#else
+    Hide();
+#endif
+}
+
+void wxIFMHintWindow::SetBitmap(const wxBitmap &bitmap)
+{
+    m_bitmap = bitmap;
+
+    if( IsShown() )
+        Refresh(false);
+}
+
+void wxIFMHintWindow::MoveHint(const wxRect &rect)
+{
+    if( m_outline )
+    {
+        // only reshape when the size changes, moving keeps the region valid
+        if( !m_shaped || rect.GetSize() != m_rect.GetSize() )
+        {
+            wxRegion region(0, 0, rect.width, rect.height);
+            if( rect.width > IFM_HINT_OUTLINE_WIDTH * 2 && rect.height > IFM_HINT_OUTLINE_WIDTH * 2 )
+                region.Subtract(wxRect(IFM_HINT_OUTLINE_WIDTH, IFM_HINT_OUTLINE_WIDTH,
+                    rect.width - IFM_HINT_OUTLINE_WIDTH * 2, rect.height - IFM_HINT_OUTLINE_WIDTH * 2));
+            SetShape(region);
+            m_shaped = true;
+        }
+    }
+    else if( m_shaped )
+    {
+        SetShape(wxRegion());
+        m_shaped = false;
+    }
+
+    SetSize(rect);
+    m_rect = rect;
+}
+
+void wxIFMHintWindow::OnEraseBackground(wxEraseEvent &WXUNUSED(event))
+{
+
+}
+
+void wxIFMHintWindow::OnPaint(wxPaintEvent &WXUNUSED(event))
+{
+    wxPaintDC dc(this);
+
+    if( m_bitmap.Ok() )
+    {
+        dc.DrawBitmap(m_bitmap, 0, 0, false);
+        return;
+    }
+
+    int w, h;
+
+    GetClientSize(&w, &h);
+    dc.SetBrush(*wxGREY_BRUSH);
+    dc.SetPen(*wxGREY_PEN);
+    dc.DrawRectangle(0, 0, w, h);
+}
+
 /*
     wxIFMDefaultChildData implementation
 */
@@ -3248,13 +4239,15 @@ wxIFMDefaultChildData::wxIFMDefaultChildData(const wxIFMChildDataBase &data)
 */
 wxIFMContainerData::wxIFMContainerData()
     : wxIFMExtensionDataBase()/*,
-    m_buttonManager(0,0)*/
+    m_buttonManager(0,0)*/,
+    m_index(-1)
 { }
 
 wxIFMContainerData::wxIFMContainerData(wxIFMInterfacePluginBase *ip, wxIFMComponent *c)
     : wxIFMExtensionDataBase(),
     //m_buttonManager(ip, c),
-    m_orientation(IFM_ORIENTATION_NONE)
+    m_orientation(IFM_ORIENTATION_NONE),
+    m_index(-1)
 { }
 
 wxIFMComponentDataKeyType wxIFMContainerData::GetDataKey() const
@@ -3304,6 +4297,12 @@ wxIFMPanelData::~wxIFMPanelData()
         delete m_tabs[i];
 }
 
+void wxIFMPanelData::InvalidateDecorations()
+{
+    m_caption_cache.Invalidate();
+    m_tabs_cache.Invalidate();
+}
+
 wxIFMComponentDataKeyType wxIFMPanelData::GetDataKey() const
 {
     return IFM_TABBED_PANEL_DATA_KEY;
@@ -3314,6 +4313,59 @@ wxIFMComponentDataKeyType wxIFMPanelData::DataKey()
     return IFM_TABBED_PANEL_DATA_KEY;
 }
 
+/*
+    wxIFMDecorationCache implementation
+*/
+bool wxIFMDecorationCache::BeginRender(wxMemoryDC &dc, const wxRect &rect)
+{
+    if( rect.width <= 0 || rect.height <= 0 )
+        return false;
+
+    // only reallocate the bitmap if the size changed
+    if( !m_bitmap.Ok() || m_bitmap.GetWidth() != rect.width || m_bitmap.GetHeight() != rect.height )
+        m_bitmap = wxBitmap(rect.width, rect.height);
+
+    m_rect = rect;
+
+    dc.SelectObject(m_bitmap);
+
+    // offset the dc so that drawing code can use component coordinates
+    dc.SetDeviceOrigin(-rect.x, -rect.y);
+
+    return true;
+}
+
+void wxIFMDecorationCache::EndRender(wxMemoryDC &dc)
+{
+    dc.SetDeviceOrigin(0, 0);
+    dc.SelectObject(wxNullBitmap);
+    m_valid = true;
+}
+
+void wxIFMDecorationCache::Blit(wxDC &dc, const wxRegion &region)
+{
+    if( !m_valid )
+        return;
+
+    wxRegion damaged = region;
+    damaged.Intersect(m_rect);
+
+    if( damaged.IsEmpty() )
+        return;
+
+    wxMemoryDC mdc;
+    mdc.SelectObject(m_bitmap);
+
+    // only copy the parts of the decoration that need painting
+    for( wxRegionIterator i(damaged); i; ++i )
+    {
+        wxRect rect = i.GetRect();
+        dc.Blit(rect.x, rect.y, rect.width, rect.height, &mdc, rect.x - m_rect.x, rect.y - m_rect.y);
+    }
+
+    mdc.SelectObject(wxNullBitmap);
+}
+
 
 wxIFMTabConfig::wxIFMTabConfig()
 : m_font_color(wxSystemSettings::GetColour(wxSYS_COLOUR_BTNTEXT)),
@@ -3345,11 +4397,11 @@ const wxFont &wxIFMTabConfig::get_font() const
 
 void wxIFMTabConfig::set_font(const wxFont &font)
 {
-    m_font = font;
+    // labels measured with the old font are no longer needed
+    wxIFMDefaultPanelPlugin::GetTextExtentCache().Remove(m_font);
 
-    wxMemoryDC dc;
-    dc.SetFont(m_font);
-    dc.GetTextExtent(wxT(" "), 0, &m_font_height, 0, 0);
+    m_font = font;
+    m_font_height = wxIFMDefaultPanelPlugin::GetTextExtentCache().GetTextExtent(wxT(" "), m_font).GetHeight();
 
     m_tab_padding = m_font_height / 4;
     m_tab_height = m_font_height + m_tab_padding * 2;
@@ -3401,6 +4453,83 @@ void wxIFMTabConfig::set_tab_spacing(int spacing)
     m_tab_spacing = spacing;
 }
 
+/*
+wxIFMTextExtentCache implementation
+*/
+#define IFM_TEXT_EXTENT_MAX_FONTS   8 //!< number of fonts to cache extents for before starting over
+#define IFM_TEXT_EXTENT_MAX_STRINGS 4096 //!< number of strings to cache per font before starting over
+
+wxIFMTextExtentCache::~wxIFMTextExtentCache()
+{
+    Clear();
+}
+
+wxSize wxIFMTextExtentCache::GetTextExtent(const wxString &text, const wxFont &font, wxWindow *window)
+{
+    wxIFMTextExtentFont *entry = NULL;
+
+    for( size_t i = 0, count = m_fonts.GetCount(); i < count; ++i )
+    {
+        if( m_fonts[i]->m_font == font )
+        {
+            entry = m_fonts[i];
+            break;
+        }
+    }
+
+    if( !entry )
+    {
+        if( m_fonts.GetCount() >= IFM_TEXT_EXTENT_MAX_FONTS )
+            Clear();
+
+        entry = new wxIFMTextExtentFont;
+        entry->m_font = font;
+        m_fonts.push_back(entry);
+    }
+
+    wxIFMTextExtentMap::iterator it = entry->m_extents.find(text);
+    if( it != entry->m_extents.end() )
+        return it->second;
+
+    // not measured yet
+    int w = 0, h = 0;
+    if( window )
+        window->GetTextExtent(text, &w, &h, 0, 0, &font);
+    else
+    {
+        wxMemoryDC dc;
+        dc.SetFont(font);
+        dc.GetTextExtent(text, &w, &h, 0, 0);
+    }
+
+    if( entry->m_extents.size() >= IFM_TEXT_EXTENT_MAX_STRINGS )
+        entry->m_extents.clear();
+
+    wxSize size(w, h);
+    entry->m_extents[text] = size;
+    return size;
+}
+
+void wxIFMTextExtentCache::Remove(const wxFont &font)
+{
+    for( size_t i = 0, count = m_fonts.GetCount(); i < count; ++i )
+    {
+        if( m_fonts[i]->m_font == font )
+        {
+            delete m_fonts[i];
+            m_fonts.RemoveAt(i);
+            return;
+        }
+    }
+}
+
+void wxIFMTextExtentCache::Clear()
+{
+    for( size_t i = 0, count = m_fonts.GetCount(); i < count; ++i )
+        delete m_fonts[i];
+    m_fonts.Clear();
+}
+
 wxIFMCaptionConfig::wxIFMCaptionConfig()
 : m_font_color(wxSystemSettings::GetColour(wxSYS_COLOUR_CAPTIONTEXT)),
 m_caption_color(wxSystemSettings::GetColour(wxSYS_COLOUR_ACTIVECAPTION)),
@@ -3431,11 +4560,11 @@ const wxFont &wxIFMCaptionConfig::get_font() const
 
 void wxIFMCaptionConfig::set_font(const wxFont &font)
 {
-    m_font = font;
+    // labels measured with the old font are no longer needed
+    wxIFMDefaultPanelPlugin::GetTextExtentCache().Remove(m_font);
 
-    wxMemoryDC dc;
-    dc.SetFont(m_font);
-    dc.GetTextExtent(wxT(" "), 0, &m_font_height, 0, 0);
+    m_font = font;
+    m_font_height = wxIFMDefaultPanelPlugin::GetTextExtentCache().GetTextExtent(wxT(" "), m_font).GetHeight();
 
     m_padding = m_font_height / 4;
     m_size = m_font_height + m_padding;
@@ -46,6 +46,7 @@ BEGIN_EVENT_TABLE(wxIFMDefaultPlugin, wxEvtHandler)
     EVT_IFM_ENDPAINT        (wxIFMDefaultPlugin::OnEndPaint)
     EVT_IFM_PAINTBG         (wxIFMDefaultPlugin::OnPaintBg)
     EVT_IFM_PAINTBORDER     (wxIFMDefaultPlugin::OnPaintBorder)
+    EVT_IFM_BUILDDISPLAYLIST (wxIFMDefaultPlugin::OnBuildDisplayList)
 
     EVT_IFM_DOCK            (wxIFMDefaultPlugin::OnDock)
     EVT_IFM_UNDOCK          (wxIFMDefaultPlugin::OnUndock)
@@ -122,6 +123,7 @@ void wxIFMDefaultPlugin::OnSetRect(wxIFMRectEvent &event)
             rect.height = max_size.GetHeight();
 
         component->m_rect = rect;
+        component->InvalidateBounds();
     }
     else if( type == wxEVT_IFM_SETBACKGROUNDRECT )
     {
@@ -158,6 +160,7 @@ void wxIFMDefaultPlugin::OnSetRect(wxIFMRectEvent &event)
 
         // set the rect
         component->m_rect = rect;
+        component->InvalidateBounds();
     }
     else if( type == wxEVT_IFM_SETCLIENTRECT )
     {
@@ -194,6 +197,7 @@ void wxIFMDefaultPlugin::OnSetRect(wxIFMRectEvent &event)
 
         // set the new rect
         component->m_rect = rect;
+        component->InvalidateBounds();
     }
 #ifdef __WXDEBUG__
     else
@@ -606,6 +610,7 @@ void wxIFMDefaultPlugin::OnDock(wxIFMDockEvent &event)
 
     component->m_docked = true;
     component->m_parent = destination;
+    wxIFMComponent::InvalidateTreeLabels();
 
 #if IFM_CANFLOAT
     wxIFMFloatingData *floating_data = IFM_GET_EXTENSION_DATA(destination, wxIFMFloatingData);
@@ -630,6 +635,8 @@ void wxIFMDefaultPlugin::OnDock(wxIFMDockEvent &event)
         // add it where it wants to be
         destination->m_children.insert(destination->m_children.begin() + index, component);
     }
+
+    destination->ChildrenChanged(component, true);
 }
 
 void wxIFMDefaultPlugin::OnUpdate(wxIFMUpdateComponentEvent &event)
@@ -642,6 +649,7 @@ void wxIFMDefaultPlugin::OnUpdate(wxIFMUpdateComponentEvent &event)
 
     // invalidate the current (old)position
     component->GetParentWindow()->RefreshRect(component->m_rect);
+    GetIP()->InvalidateDisplayLists();
 
     // size and position the component
     wxIFMRectEvent rectevt(wxEVT_IFM_SETRECT, component, event.GetRect());
@@ -687,7 +695,27 @@ void wxIFMDefaultPlugin::OnBeginPaint(wxIFMBeginPaintEvent &event)
 
     // create a dc
     if( event.GetOnPaint() )
-        dc = new wxBufferedPaintDC(event.GetWindow());
+    {
+        wxBitmap *buffer = event.GetBuffer();
+        if( buffer )
+        {
+            // reuse the windows back buffer, only reallocating it when the window grows
+            wxSize size = event.GetWindow()->GetClientSize();
+            if( !buffer->Ok() || buffer->GetWidth() < size.x || buffer->GetHeight() < size.y )
+            {
+                if( buffer->Ok() )
+                {
+                    size.x = wxMax(size.x, buffer->GetWidth());
+                    size.y = wxMax(size.y, buffer->GetHeight());
+                }
+                *buffer = wxBitmap(wxMax(size.x, 1), wxMax(size.y, 1));
+            }
+
+            dc = new wxBufferedPaintDC(event.GetWindow(), *buffer);
+        }
+        else
+            dc = new wxBufferedPaintDC(event.GetWindow());
+    }
     else
         dc = new wxClientDC(event.GetWindow());
 
@@ -790,6 +818,65 @@ void wxIFMDefaultPlugin::OnPaintBorder(wxIFMPaintEvent &event)
     }
 }
 
+void wxIFMDefaultPlugin::OnBuildDisplayList(wxIFMDisplayListEvent &event)
+{
+    wxIFMComponent *component = event.GetComponent();
+
+    // don't need to record anything if we arent visible
+    if( !component->IsVisible() )
+        return;
+
+    // decorations are left to other plugins
+    if( event.GetPhase() == IFM_DISPLAY_DECORATIONS )
+        return;
+
+    wxIFMRectEvent rectevt(wxEVT_IFM_GETBACKGROUNDRECT, component);
+    GetIP()->ProcessPluginEvent(rectevt);
+    wxRect rect = rectevt.GetRect();
+
+    wxIFMDisplayList &list = event.GetDisplayList();
+
+    if( event.GetPhase() == IFM_DISPLAY_BACKGROUND )
+    {
+        // same as OnPaintBg
+        wxColour color(wxSystemSettings::GetColour(wxSYS_COLOUR_BTNFACE));
+        list.AddRectangle(rect, wxPen(color), wxBrush(color));
+        return;
+    }
+
+    // same as OnPaintBorder
+    rect.y--;
+    rect.x--;
+    rect.width++;
+    rect.height++;
+
+    wxPen border_pen(wxSystemSettings::GetColour(wxSYS_COLOUR_BTNSHADOW));
+
+    if( component->m_borders.top )
+    {
+        border_pen.SetWidth(component->m_borders.top);
+        list.AddLine(rect.x, rect.y, rect.x + rect.width, rect.y, border_pen);
+    }
+
+    if( component->m_borders.left )
+    {
+        border_pen.SetWidth(component->m_borders.left);
+        list.AddLine(rect.x, rect.y, rect.x, rect.y + rect.height, border_pen);
+    }
+
+    if( component->m_borders.right )
+    {
+        border_pen.SetWidth(component->m_borders.right);
+        list.AddLine(rect.x + rect.width, rect.y, rect.x + rect.width, rect.y + rect.height + 1, border_pen);
+    }
+
+    if( component->m_borders.bottom )
+    {
+        border_pen.SetWidth(component->m_borders.bottom);
+        list.AddLine(rect.x, rect.y + rect.height, rect.x + rect.width + 1, rect.y + rect.height, border_pen);
+    }
+}
+
 void wxIFMDefaultPlugin::OnUndock(wxIFMUndockEvent &event)
 {
     wxIFMComponent *component = event.GetComponent();
@@ -806,6 +893,7 @@ void wxIFMDefaultPlugin::OnUndock(wxIFMUndockEvent &event)
         {
             //children.RemoveAt(i);
             children.erase(i);
+            parent->ChildrenChanged(component, false);
             break;
         }
     }
@@ -841,6 +929,7 @@ void wxIFMDefaultPlugin::OnUndock(wxIFMUndockEvent &event)
 
     component->m_docked = false;
     component->m_parent = NULL;
+    wxIFMComponent::InvalidateTreeLabels();
 }
 
 void wxIFMDefaultPlugin::OnDeleteComponent(wxIFMDeleteComponentEvent &event)
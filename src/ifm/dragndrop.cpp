@@ -30,10 +30,55 @@
 
 #include "wx/msgdlg.h"
 #include "wx/settings.h"
+#include "wx/dcscreen.h"
 
-// images used for rendering drop targets
-wxBitmap img_left, img_right, img_top, img_bottom, img_tab,
-    img_leftHover, img_rightHover, img_topHover, img_bottomHover, img_tabHover;
+#define IFM_DOCK_GLYPH_COUNT 5 //!< number of dock_button_icons
+
+/*!
+    Returns the atlas used for rendering drop targets. The first row holds the normal
+    glyphs and the second row the hover glyphs, one column per dock_button_icons value.
+    The glyphs are composited onto an opaque bitmap the first time this is called so that
+    painting a button is a single blit without any mask processing.
+*/
+static const wxBitmap &GetDockGlyphAtlas()
+{
+    static wxBitmap atlas;
+
+    if( !atlas.Ok() )
+    {
+        char **glyphs[IFM_DOCK_GLYPH_COUNT * 2] =
+        {
+            dock_left_xpm, dock_right_xpm, dock_up_xpm, dock_down_xpm, dock_center_xpm,
+            dock_left_mo_xpm, dock_right_mo_xpm, dock_up_mo_xpm, dock_down_mo_xpm, dock_center_mo_xpm
+        };
+
+        atlas.Create(IFM_DOCK_TARGET_BUTTON_WIDTH * IFM_DOCK_GLYPH_COUNT, IFM_DOCK_TARGET_BUTTON_WIDTH * 2);
+
+        wxMemoryDC dc;
+        dc.SelectObject(atlas);
+        for( int i = 0; i < IFM_DOCK_GLYPH_COUNT * 2; ++i )
+            dc.DrawBitmap(wxBitmap(glyphs[i]), (i % IFM_DOCK_GLYPH_COUNT) * IFM_DOCK_TARGET_BUTTON_WIDTH,
+                (i / IFM_DOCK_GLYPH_COUNT) * IFM_DOCK_TARGET_BUTTON_WIDTH, false);
+        dc.SelectObject(wxNullBitmap);
+    }
+
+    return atlas;
+}
+
+/*
+    Returns true if undocking component would leave ancestor without children. Undocking
+    deletes every ancestor it leaves empty, so such an ancestor can't be a drop target.
+*/
+static bool IsEmptiedByUndock(wxIFMComponent *component, wxIFMComponent *ancestor)
+{
+    for( ; component->m_parent && component->m_parent->m_children.GetCount() == 1; component = component->m_parent )
+    {
+        if( component->m_parent == ancestor )
+            return true;
+    }
+
+    return false;
+}
 
 DEFINE_EVENT_TYPE(wxEVT_IFM_INITDRAG);
 DEFINE_EVENT_TYPE(wxEVT_IFM_BEGINDRAG);
@@ -67,9 +112,15 @@ wxIFMDefaultDockingPlugin::wxIFMDefaultDockingPlugin()
     m_captured(false),
     m_dragx(0),
     m_dragy(0),
-    m_oldBtn(NULL)
+    m_hint(NULL),
+    m_oldBtn(NULL),
+    m_frameButtonsShown(false),
+    m_componentButtonsShown(false),
+    m_targetValid(false)
 #if IFM_CANFLOAT
     ,m_window(NULL)
+    ,m_ghosting(false)
+    ,m_ghost(NULL)
 #endif
 { }
 
@@ -86,21 +137,33 @@ bool wxIFMDefaultDockingPlugin::Initialize(wxIFMInterfacePluginBase *plugin)
         return false;
     }
 
-    // initialize drop bitmaps
-    img_left = wxBitmap(dock_left_xpm);
-    img_leftHover = wxBitmap(dock_left_mo_xpm);
-    img_top = wxBitmap(dock_up_xpm);
-    img_topHover = wxBitmap(dock_up_mo_xpm);
-    img_bottom = wxBitmap(dock_down_xpm);
-    img_bottomHover = wxBitmap(dock_down_mo_xpm);
-    img_right = wxBitmap(dock_right_xpm);
-    img_rightHover = wxBitmap(dock_right_mo_xpm);
-    img_tab = wxBitmap(dock_center_xpm);
-    img_tabHover = wxBitmap(dock_center_mo_xpm);
+    m_motion.SetPlugin(plugin);
 
     return true;
 }
 
+void wxIFMDefaultDockingPlugin::Shutdown()
+{
+    m_motion.Cancel();
+    DestroyTargetButtons();
+
+#if IFM_CANFLOAT
+    m_emptyContainer = wxIFMComponentHandle();
+
+    if( m_ghost )
+    {
+        m_ghost->Destroy();
+        m_ghost = NULL;
+    }
+#endif
+
+    if( m_hint )
+    {
+        m_hint->Destroy();
+        m_hint = NULL;
+    }
+}
+
 #if IFM_CANFLOAT
 void wxIFMDefaultDockingPlugin::OnLeftDClick(wxIFMMouseEvent &event)
 {
@@ -163,6 +226,9 @@ void wxIFMDefaultDockingPlugin::OnLeftUp(wxIFMMouseEvent &event)
 
     if( m_dragging )
     {
+        // catch up with the pointer before dropping
+        m_motion.Flush();
+
         m_dragging = false;
         wxIFMDragEvent evt(wxEVT_IFM_ENDDRAG, event.GetComponent(),
             event.GetMouseEvent().GetPosition(),
@@ -181,6 +247,9 @@ void wxIFMDefaultDockingPlugin::OnMouseMove(wxIFMMouseEvent &event)
 
     if( m_dragging )
     {
+        if( !m_motion.Schedule(event) )
+            return;
+
         wxIFMDragEvent evt(wxEVT_IFM_DRAGGING, component, pos,
             event.GetMouseEvent().AltDown(), event.GetMouseEvent().ShiftDown(),
             event.GetMouseEvent().ControlDown(), m_realtime);
@@ -216,6 +285,7 @@ void wxIFMDefaultDockingPlugin::OnKeyDown(wxIFMKeyEvent &event)
         int keycode = event.GetKeyEvent().GetKeyCode();
         if( keycode == WXK_ESCAPE )
         {
+            m_motion.Cancel();
             m_dragging = false;
             m_captured = false;
             GetManager()->ReleaseInput();
@@ -289,8 +359,16 @@ void wxIFMDefaultDockingPlugin::OnDragBegin(wxIFMDragEvent &event)
 
     wxIFMFloatingWindowBase *floating_parent = floating_data->m_window;
 
+    m_window = NULL;
+
+    // with ghost dragging, docked components stay docked until they are dropped
+    if( !floating_data->m_floating && (GetManager()->GetFlags() & IFM_GHOST_DRAG) &&
+        BeginGhostDrag(component, pos) )
+    {
+        // the component is floated or docked when the snapshot is dropped
+    }
     // float the window immediately (if not floating already)
-    if( !floating_data->m_floating )
+    else if( !floating_data->m_floating )
     {
         m_offset = wxPoint(12,12);
         wxIFMFloatEvent floatevt(component, pos, floating_data->m_rect.GetSize());
@@ -324,8 +402,11 @@ void wxIFMDefaultDockingPlugin::OnDragBegin(wxIFMDragEvent &event)
             // fix the offset being incorrect if you are re-floating an already floating window
             m_offset = wxPoint(12,12);
 
-            // don't delete the old floating window to prevent wierd bugs
-            //! \todo Investigate these bugs!
+            // don't delete anything while dragging, deleting windows here breaks mouse capture.
+            // The container we leave behind is removed when the drag ends if it is still empty.
+            if( component->m_parent->GetType() == IFM_COMPONENT_CONTAINER )
+                m_emptyContainer = component->m_parent->GetHandle();
+
             wxIFMUndockEvent evt(component, false);
             GetIP()->ProcessPluginEvent(evt);
 
@@ -355,11 +436,89 @@ void wxIFMDefaultDockingPlugin::OnDragBegin(wxIFMDragEvent &event)
     GetManager()->DisplayStatusMessage(wxT("Hold down alt to prevent drop target buttons from moving. Hold down shift to hide drop target buttons."));
 }
 
+#if IFM_CANFLOAT
+bool wxIFMDefaultDockingPlugin::BeginGhostDrag(wxIFMComponent *component, const wxPoint &pos)
+{
+    wxIFMRectEvent rectevt(wxEVT_IFM_GETRECT, component);
+    GetIP()->ProcessPluginEvent(rectevt);
+    wxRect rect = rectevt.GetRect();
+
+    if( rect.width <= 0 || rect.height <= 0 )
+        return false;
+
+    rect.SetPosition(component->GetParentWindow()->ClientToScreen(rect.GetPosition()));
+
+    // take the snapshot from the screen so child windows are included
+    wxBitmap bmp(rect.width, rect.height);
+    {
+        wxScreenDC sdc;
+        wxMemoryDC mdc;
+        mdc.SelectObject(bmp);
+        mdc.Blit(0, 0, rect.width, rect.height, &sdc, rect.x, rect.y);
+        mdc.SelectObject(wxNullBitmap);
+    }
+
+    if( !m_ghost )
+        m_ghost = new wxIFMHintWindow(GetManager()->GetParent());
+
+    // keep the snapshot in the same position relative to the mouse
+    m_offset = pos - rect.GetPosition();
+    m_ghostRect = rect;
+    m_ghosting = true;
+
+    m_ghost->SetBitmap(bmp);
+    m_ghost->ShowHint(m_ghostRect);
+
+    return true;
+}
+
+void wxIFMDefaultDockingPlugin::EndGhostDrag()
+{
+    if( !m_ghosting )
+        return;
+
+    m_ghosting = false;
+    m_ghost->HideHint();
+    m_ghost->SetBitmap(wxNullBitmap);
+}
+
+void wxIFMDefaultDockingPlugin::RemoveEmptyContainer()
+{
+    // the container may have been deleted, or docked into, during the drag
+    wxIFMComponent *container = m_emptyContainer.Get();
+    m_emptyContainer = wxIFMComponentHandle();
+
+    if( !container || !container->m_docked || container->m_children.GetCount() != 0 )
+        return;
+
+    wxIFMFloatingData *floating_data = IFM_GET_EXTENSION_DATA(container, wxIFMFloatingData);
+    if( !floating_data->m_floating )
+        return;
+
+    wxIFMFloatingWindowBase *window = floating_data->m_window;
+
+    // deleting undocks the container, which deletes empty parents and destroys the
+    // floating window if nothing is left in it
+    wxIFMDeleteComponentEvent delevt(container);
+    GetIP()->ProcessPluginEvent(delevt);
+
+    if( window->GetComponent()->m_children.GetCount() != 0 )
+        window->Update();
+}
+#endif
+
 void wxIFMDefaultDockingPlugin::OnDragEnd(wxIFMDragEvent &event)
 {
     ShowComponentDropButtons(false);
     ShowFrameDropButtons(false);
 
+#if IFM_CANFLOAT
+    // remember where the snapshot was dropped before hiding it
+    bool ghosting = m_ghosting;
+    wxPoint ghost_pos = m_ghostRect.GetPosition();
+    EndGhostDrag();
+#endif
+
     if( !event.WasCanceled() )
     {
         wxPoint pos = event.GetPosition();
@@ -377,7 +536,15 @@ void wxIFMDefaultDockingPlugin::OnDragEnd(wxIFMDragEvent &event)
 
         wxIFMComponent *destination = NULL;
 
-        if( m_oldBtn && !(m_oldBtn->GetId() == IFM_DOCK_ID_TAB && !m_oldBtn->GetComponent()) )
+        // the undock below deletes the ancestors it empties and containers may collapse,
+        // so only refer to the drop target through a handle until the component is undocked
+        wxIFMComponent *target = m_oldBtn ? m_oldBtn->GetComponent() : NULL;
+        wxIFMComponentHandle target_handle;
+        if( target )
+            target_handle = target->GetHandle();
+
+        if( m_oldBtn && !(m_oldBtn->GetId() == IFM_DOCK_ID_TAB && !target) &&
+            !(target && IsEmptiedByUndock(component, target)) )
         {
             wxIFMComponent *parent = component->m_parent;
             if( parent )
@@ -414,7 +581,24 @@ void wxIFMDefaultDockingPlugin::OnDragEnd(wxIFMDragEvent &event)
             // generate the appropriate dock event
             int id = m_oldBtn->GetId();
 
-            if( !m_oldBtn->GetComponent() )
+            bool target_lost = target && !target_handle.IsOk();
+            target = target_handle.Get();
+
+#if IFM_CANFLOAT
+            if( target_lost )
+            {
+                // the drop target went away with the undock, treat this as a drop outside any target
+                wxPoint float_pos = ghosting ? ghost_pos : IFM_DEFAULT_RECT.GetPosition();
+                wxIFMFloatEvent floatevt(component, float_pos, floating_data->m_rect.GetSize());
+                GetIP()->ProcessPluginEvent(floatevt);
+            }
+            else
+#else
+            // the drop target went away with the undock, give the component a container of its own
+            if( target_lost )
+                id = IFM_DOCK_ID_BOTTOM;
+#endif
+            if( !target )
             {
                 wxIFMComponent *container;
 
@@ -482,7 +666,7 @@ void wxIFMDefaultDockingPlugin::OnDragEnd(wxIFMDragEvent &event)
             }
             else
             {
-                destination = m_oldBtn->GetComponent();
+                destination = target;
                 wxIFMComponent *container = NULL;
                 int index = 0;
 
@@ -493,9 +677,8 @@ void wxIFMDefaultDockingPlugin::OnDragEnd(wxIFMDragEvent &event)
                 if( destination->GetType() == IFM_COMPONENT_PANEL )
                 {
                     wxIFMComponent *parent = destination->m_parent;
-                    const wxIFMComponentList &containers = m_ip->GetTopContainerList();
 
-                    if( parent && containers.Find(parent) && parent->m_children.size() == 1 &&
+                    if( parent && m_ip->GetTopContainerIndex(parent) != -1 && parent->m_children.size() == 1 &&
                         (
                             (parent->m_alignment == IFM_ALIGN_VERTICAL && (id == IFM_DOCK_ID_LEFT || id == IFM_DOCK_ID_RIGHT)) ||
                             (parent->m_alignment == IFM_ALIGN_HORIZONTAL && (id == IFM_DOCK_ID_TOP || id == IFM_DOCK_ID_BOTTOM))
@@ -638,6 +821,15 @@ void wxIFMDefaultDockingPlugin::OnDragEnd(wxIFMDragEvent &event)
 #if IFM_CANFLOAT
         else
         {
+            if( ghosting )
+            {
+                // the component is still docked, float it where the snapshot was dropped
+                wxIFMFloatEvent floatevt(component, ghost_pos, floating_data->m_rect.GetSize());
+                GetIP()->ProcessPluginEvent(floatevt);
+
+                GetManager()->Update();
+            }
+
             component->GetParentWindow()->SetFocus();
         }
 
@@ -652,9 +844,15 @@ void wxIFMDefaultDockingPlugin::OnDragEnd(wxIFMDragEvent &event)
 #endif
     }
 
-    DestroyTargetButtons();
+    HideTargetButtons();
+    ShowHintRect(NULL);
 
     m_oldBtn = NULL;
+#if IFM_CANFLOAT
+    m_window = NULL;
+
+    RemoveEmptyContainer();
+#endif
 
     GetManager()->ResetStatusMessage();
 }
@@ -728,6 +926,11 @@ void wxIFMDefaultDockingPlugin::OnDrag(wxIFMDragEvent &event)
         // move the floating window
         if( m_window )
             m_window->GetWindow()->Move(pos - m_offset);
+        else if( m_ghosting )
+        {
+            m_ghostRect.SetPosition(pos - m_offset);
+            m_ghost->ShowHint(m_ghostRect);
+        }
 #endif
 
         m_oldPos = pos;
@@ -736,6 +939,9 @@ void wxIFMDefaultDockingPlugin::OnDrag(wxIFMDragEvent &event)
     if( m_oldBtn && m_oldBtn != btn )
             m_oldBtn->SetHover(false);
 
+    if( btn != m_oldBtn )
+        ShowHintRect(btn);
+
     m_oldBtn = btn;
 }
 
@@ -809,20 +1015,62 @@ void wxIFMDefaultDockingPlugin::OnDock(wxIFMDockEvent &event)
     event.Skip();
 }
 
-void wxIFMDefaultDockingPlugin::DrawHintRect(wxDC &dc, const wxRect &rect)
+void wxIFMDefaultDockingPlugin::ShowHintRect(wxIFMDockTargetButton *btn)
 {
-    dc.SetPen(*wxGREY_PEN);
-    dc.SetLogicalFunction(wxXOR);
-
-    // draw border
-    int top = rect.y, left = rect.x, right = left + rect.width - 1, bottom = top + rect.height - 1;
-    dc.DrawLine(left + 1, top, right, top);
-    dc.DrawLine(left, top, left, bottom);
-    dc.DrawLine(left, bottom, right + 1, bottom);
-    dc.DrawLine(right, top, right, bottom);
-
-    dc.SetLogicalFunction(wxCOPY);
-    dc.SetPen(wxNullPen);
+    if( !btn )
+    {
+        if( m_hint )
+            m_hint->HideHint();
+        m_hintRect = wxRect();
+        return;
+    }
+
+    // find the area the button docks into, in screen coordinates
+    wxRect rect;
+    wxIFMComponent *component = btn->GetComponent();
+    if( component )
+    {
+        wxIFMRectEvent rectevt(wxEVT_IFM_GETRECT, component);
+        GetIP()->ProcessPluginEvent(rectevt);
+        rect = rectevt.GetRect();
+        rect.SetPosition(component->GetParentWindow()->ClientToScreen(rect.GetPosition()));
+    }
+    else
+    {
+        rect = GetManager()->GetInterfaceRect();
+        rect.SetPosition(GetManager()->GetParent()->ClientToScreen(rect.GetPosition()));
+    }
+
+    switch(btn->GetId())
+    {
+        case IFM_DOCK_ID_LEFT:
+        case IFM_DOCK_ID_FRAME_LEFT:
+            rect.width /= 2;
+            break;
+        case IFM_DOCK_ID_RIGHT:
+        case IFM_DOCK_ID_FRAME_RIGHT:
+            rect.x += rect.width / 2;
+            rect.width -= rect.width / 2;
+            break;
+        case IFM_DOCK_ID_TOP:
+        case IFM_DOCK_ID_FRAME_TOP:
+            rect.height /= 2;
+            break;
+        case IFM_DOCK_ID_BOTTOM:
+        case IFM_DOCK_ID_FRAME_BOTTOM:
+            rect.y += rect.height / 2;
+            rect.height -= rect.height / 2;
+            break;
+    }
+
+    if( rect == m_hintRect )
+        return;
+    m_hintRect = rect;
+
+    if( !m_hint )
+        m_hint = new wxIFMHintWindow(GetManager()->GetParent());
+
+    m_hint->ShowHint(rect, true);
 }
 
 inline void create_helper(DockButtonArray &array, wxIFMDockTargetButton *btn)
@@ -841,28 +1089,42 @@ void wxIFMDefaultDockingPlugin::CreateTargetButtons()
     wxRect client_rect = GetManager()->GetInterfaceRect();
     client_rect.SetPosition(GetManager()->GetParent()->ClientToScreen(client_rect.GetPosition()));
 
+    wxPoint frame_pos[4];
+
     // left button
-    pos.x = IFM_DOCK_TARGET_BUTTON_WIDTH + client_rect.x;
-    pos.y = client_rect.height / 2 - IFM_DOCK_TARGET_BUTTON_WIDTH / 2 + client_rect.y;
-    btn = new wxIFMDockTargetButton(parent, pos, IFM_DOCK_ID_FRAME_LEFT, IFM_DOCK_ICON_LEFT);
-    create_helper(m_dockButtonArray, btn);
+    frame_pos[0].x = IFM_DOCK_TARGET_BUTTON_WIDTH + client_rect.x;
+    frame_pos[0].y = client_rect.height / 2 - IFM_DOCK_TARGET_BUTTON_WIDTH / 2 + client_rect.y;
 
     // top button
-    pos.x = client_rect.width / 2 - IFM_DOCK_TARGET_BUTTON_WIDTH / 2 + client_rect.x;
-    pos.y = IFM_DOCK_TARGET_BUTTON_WIDTH + client_rect.y;
-    btn = new wxIFMDockTargetButton(parent, pos, IFM_DOCK_ID_FRAME_TOP, IFM_DOCK_ICON_TOP);
-    create_helper(m_dockButtonArray, btn);
+    frame_pos[1].x = client_rect.width / 2 - IFM_DOCK_TARGET_BUTTON_WIDTH / 2 + client_rect.x;
+    frame_pos[1].y = IFM_DOCK_TARGET_BUTTON_WIDTH + client_rect.y;
 
     // right button
-    pos.x = client_rect.width - IFM_DOCK_TARGET_BUTTON_WIDTH - IFM_DOCK_TARGET_BUTTON_WIDTH + client_rect.x;
-    pos.y = client_rect.height / 2 - IFM_DOCK_TARGET_BUTTON_WIDTH / 2 + client_rect.y;
-    btn = new wxIFMDockTargetButton(parent, pos, IFM_DOCK_ID_FRAME_RIGHT, IFM_DOCK_ICON_RIGHT);
-    create_helper(m_dockButtonArray, btn);
+    frame_pos[2].x = client_rect.width - IFM_DOCK_TARGET_BUTTON_WIDTH - IFM_DOCK_TARGET_BUTTON_WIDTH + client_rect.x;
+    frame_pos[2].y = client_rect.height / 2 - IFM_DOCK_TARGET_BUTTON_WIDTH / 2 + client_rect.y;
 
     // bottom button
-    pos.x = client_rect.width / 2 - IFM_DOCK_TARGET_BUTTON_WIDTH / 2 + client_rect.x;
-    pos.y = client_rect.height - IFM_DOCK_TARGET_BUTTON_WIDTH - IFM_DOCK_TARGET_BUTTON_WIDTH + client_rect.y;
-    btn = new wxIFMDockTargetButton(parent, pos, IFM_DOCK_ID_FRAME_BOTTOM, IFM_DOCK_ICON_BOTTOM);
+    frame_pos[3].x = client_rect.width / 2 - IFM_DOCK_TARGET_BUTTON_WIDTH / 2 + client_rect.x;
+    frame_pos[3].y = client_rect.height - IFM_DOCK_TARGET_BUTTON_WIDTH - IFM_DOCK_TARGET_BUTTON_WIDTH + client_rect.y;
+
+    // the buttons outlive the drag, so later drags only need to move the frame buttons
+    if( m_dockButtonArray.GetCount() > 0 )
+    {
+        for( int i = 0; i < 4; ++i )
+            m_dockButtonArray[i]->Move(frame_pos[i]);
+        return;
+    }
+
+    btn = new wxIFMDockTargetButton(parent, frame_pos[0], IFM_DOCK_ID_FRAME_LEFT, IFM_DOCK_ICON_LEFT);
+    create_helper(m_dockButtonArray, btn);
+
+    btn = new wxIFMDockTargetButton(parent, frame_pos[1], IFM_DOCK_ID_FRAME_TOP, IFM_DOCK_ICON_TOP);
+    create_helper(m_dockButtonArray, btn);
+
+    btn = new wxIFMDockTargetButton(parent, frame_pos[2], IFM_DOCK_ID_FRAME_RIGHT, IFM_DOCK_ICON_RIGHT);
+    create_helper(m_dockButtonArray, btn);
+
+    btn = new wxIFMDockTargetButton(parent, frame_pos[3], IFM_DOCK_ID_FRAME_BOTTOM, IFM_DOCK_ICON_BOTTOM);
     create_helper(m_dockButtonArray, btn);
 
     // Component buttons
@@ -896,14 +1158,26 @@ void wxIFMDefaultDockingPlugin::DestroyTargetButtons()
         m_dockButtonArray[i]->Destroy();
         //(*i)->Destroy();
     m_dockButtonArray.clear();
+
+    m_frameButtonsShown = m_componentButtonsShown = false;
 }
 
-void wxIFMDefaultDockingPlugin::ShowFrameDropButtons(bool show)
+void wxIFMDefaultDockingPlugin::HideTargetButtons()
 {
-    static bool last = false;
+    ShowComponentDropButtons(false);
+    ShowFrameDropButtons(false);
 
-    if( show != last )
-        last = show;
+    for( int i = 0, count = m_dockButtonArray.GetCount(); i < count; ++i )
+        m_dockButtonArray[i]->SetHover(false);
+
+    m_targetValid = false;
+    m_targetComponent = wxIFMComponentHandle();
+}
+
+void wxIFMDefaultDockingPlugin::ShowFrameDropButtons(bool show)
+{
+    if( show != m_frameButtonsShown )
+        m_frameButtonsShown = show;
     else
         return;
 
@@ -926,10 +1200,8 @@ void wxIFMDefaultDockingPlugin::ShowFrameDropButtons(bool show)
 
 void wxIFMDefaultDockingPlugin::ShowComponentDropButtons(bool show)
 {
-    static bool last = false;
-
-    if( show != last )
-        last = show;
+    if( show != m_componentButtonsShown )
+        m_componentButtonsShown = show;
     else
         return;
 
@@ -970,12 +1242,11 @@ void wxIFMDefaultDockingPlugin::OnShowDropTargets(wxIFMShowDropTargetsEvent &eve
     else if( component )
     {
         // don't display target buttons if you hover over the component you're dragging
-        // or if you're hovering over the parent of the control you are dragging and the
-        // parent's only child is the control you are dragging.
+        // or if you're hovering over an ancestor of the control you are dragging that
+        // undocking the control would leave empty.
         // also don't display buttons if hovering over the root component of a floating window
         if( (component == event.GetDraggedComponent()) ||
-            (component == event.GetDraggedComponent()->m_parent &&
-             component->m_children.GetCount() == 1) ||
+            IsEmptiedByUndock(event.GetDraggedComponent(), component) ||
 #if IFM_CANFLOAT
             (floating_data->m_floating && !component->m_docked) ||
 #endif
@@ -1015,6 +1286,24 @@ void wxIFMDefaultDockingPlugin::OnShowDropTargets(wxIFMShowDropTargetsEvent &eve
     else
         pos = GetManager()->GetParent()->ClientToScreen(pos);
 
+    wxRect client_rect = GetManager()->GetInterfaceRect();
+    client_rect.SetPosition(GetManager()->GetParent()->ClientToScreen(client_rect.GetPosition()));
+
+    // the buttons are already in place if neither the target nor the layout changed
+    // compare handles, the cached component may have been deleted and its memory reused
+    wxIFMComponentHandle target;
+    if( component )
+        target = component->GetHandle();
+
+    if( m_targetValid && target == m_targetComponent && pos == m_targetPos &&
+        client_rect == m_targetInterfaceRect )
+        return;
+
+    m_targetValid = true;
+    m_targetComponent = target;
+    m_targetPos = pos;
+    m_targetInterfaceRect = client_rect;
+
     wxIFMDockTargetButton *btn;
     wxPoint new_pos, tab_pos;
     int i = m_dockButtonArray.GetCount() - 1;
@@ -1056,9 +1345,6 @@ void wxIFMDefaultDockingPlugin::OnShowDropTargets(wxIFMShowDropTargetsEvent &eve
     rect.width = IFM_DOCK_TARGET_BUTTON_WIDTH * 3;
     rect.height = IFM_DOCK_TARGET_BUTTON_WIDTH * 3;
 
-    wxRect client_rect = GetManager()->GetInterfaceRect();
-    client_rect.SetPosition(GetManager()->GetParent()->ClientToScreen(client_rect.GetPosition()));
-
     // position the edge buttons here as well. They normally don't move,
     // but if any component drop button overlaps one of the edge buttons,
     // we need to "nudge" the edge button out of the way
@@ -1166,7 +1452,9 @@ void wxIFMDockTargetButton::SetHover(bool hover)
     if( m_hover != hover )
     {
         m_hover = hover;
-        Refresh();
+
+        // the glyph covers the whole button, there is no background to erase
+        Refresh(false);
     }
 }
 
@@ -1179,37 +1467,11 @@ void wxIFMDockTargetButton::OnPaint(wxPaintEvent &WXUNUSED(event))
 {
     wxPaintDC dc(this);
 
-    switch(m_icon)
-    {
-        case IFM_DOCK_ICON_LEFT:
-            if( m_hover )
-                dc.DrawBitmap(img_leftHover, 0, 0, false);
-            else
-                dc.DrawBitmap(img_left, 0, 0, false);
-            break;
-        case IFM_DOCK_ICON_RIGHT:
-            if( m_hover )
-                dc.DrawBitmap(img_rightHover, 0, 0, false);
-            else
-                dc.DrawBitmap(img_right, 0, 0, false);
-            break;
-        case IFM_DOCK_ICON_TOP:
-            if( m_hover )
-                dc.DrawBitmap(img_topHover, 0, 0, false);
-            else
-                dc.DrawBitmap(img_top, 0, 0, false);
-            break;
-        case IFM_DOCK_ICON_BOTTOM:
-            if( m_hover )
-                dc.DrawBitmap(img_bottomHover, 0, 0, false);
-            else
-                dc.DrawBitmap(img_bottom, 0, 0, false);
-            break;
-        case IFM_DOCK_ICON_TAB:
-            if( m_hover )
-                dc.DrawBitmap(img_tabHover, 0, 0, false);
-            else
-                dc.DrawBitmap(img_tab, 0, 0, false);
-            break;
-    }
+    wxMemoryDC atlas_dc;
+    atlas_dc.SelectObject(GetDockGlyphAtlas());
+
+    dc.Blit(0, 0, IFM_DOCK_TARGET_BUTTON_WIDTH, IFM_DOCK_TARGET_BUTTON_WIDTH, &atlas_dc,
+        m_icon * IFM_DOCK_TARGET_BUTTON_WIDTH, m_hover ? IFM_DOCK_TARGET_BUTTON_WIDTH : 0);
+
+    atlas_dc.SelectObject(wxNullBitmap);
 }
@@ -46,8 +46,11 @@ DEFINE_EVENT_TYPE(wxEVT_IFM_DELETECOMPONENT) // used to delete components (not u
 DEFINE_EVENT_TYPE(wxEVT_IFM_SHOWCOMPONENT) // used to show or hide components
 DEFINE_EVENT_TYPE(wxEVT_IFM_VISIBILITYCHANGED) // used to notify a component that is has been shown or hidden
 DEFINE_EVENT_TYPE(wxEVT_IFM_ADDCHILD) // add a child window to the interface
+DEFINE_EVENT_TYPE(wxEVT_IFM_ADDCHILDREN) // add several child windows to the interface at once
 DEFINE_EVENT_TYPE(wxEVT_IFM_SETCHILD) // used to add children to panels
 DEFINE_EVENT_TYPE(wxEVT_IFM_REMOVECHILD) // removes a child from its panel (and the interface)
+DEFINE_EVENT_TYPE(wxEVT_IFM_SAVELAYOUT) // stores the arrangement of the interface in a string
+DEFINE_EVENT_TYPE(wxEVT_IFM_LOADLAYOUT) // restores an arrangement stored by wxEVT_IFM_SAVELAYOUT
 
 DEFINE_EVENT_TYPE(wxEVT_IFM_PAINTINTERFACE) // indicates to plugins that some or all of the interface needs to be repainted
 DEFINE_EVENT_TYPE(wxEVT_IFM_PAINTBG) // paints a components background
@@ -55,6 +58,7 @@ DEFINE_EVENT_TYPE(wxEVT_IFM_PAINTBORDER) // paints a components border
 DEFINE_EVENT_TYPE(wxEVT_IFM_PAINTDECOR) // paints a components decorations
 DEFINE_EVENT_TYPE(wxEVT_IFM_BEGINPAINT)
 DEFINE_EVENT_TYPE(wxEVT_IFM_ENDPAINT)
+DEFINE_EVENT_TYPE(wxEVT_IFM_BUILDDISPLAYLIST) // records a components background, border, or decorations into a display list
 
 DEFINE_EVENT_TYPE(wxEVT_IFM_SHOW) // called to show or hide panels
 DEFINE_EVENT_TYPE(wxEVT_IFM_SHOWCHILD) // used to show children managed by the interface
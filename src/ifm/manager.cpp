@@ -23,6 +23,8 @@
 #include "wx/statusbr.h"
 #include "wx/dc.h"
 
+#include <limits.h>
+
 DEFINE_IFM_DATA_KEY(IFM_FLOATING_DATA_KEY)
 
 DEFINE_IFM_CHILD_TYPE(IFM_CHILD_GENERIC)
@@ -33,6 +35,49 @@ IMPLEMENT_DYNAMIC_CLASS(wxIFMChildDataBase, wxObject);
 #include <wx/arrimpl.cpp>
 WX_DEFINE_EXPORTED_OBJARRAY(wxRectArray);
 WX_DEFINE_EXPORTED_OBJARRAY(wxSizeArray);
+WX_DEFINE_EXPORTED_OBJARRAY(wxIFMDisplayItemArray);
+WX_DEFINE_EXPORTED_OBJARRAY(wxIFMDamageArray);
+
+/*
+    Slots handed out to components for wxIFMComponentHandle. Slots are reused once their
+    component is deleted, with a new generation.
+*/
+class wxIFMComponentStore
+{
+public:
+    wxArrayPtrVoid m_components; //!< component in each slot, NULL if the slot is free
+    wxArrayInt m_generations; //!< current generation of each slot
+    wxArrayInt m_free; //!< indices of free slots
+};
+
+static wxIFMComponentStore &GetComponentStore()
+{
+    static wxIFMComponentStore store;
+    return store;
+}
+
+#if IFM_USE_COMPONENT_SLABS
+static wxIFMSlabAllocator &GetComponentSlab()
+{
+    static wxIFMSlabAllocator slab(sizeof(wxIFMComponent));
+    return slab;
+}
+
+static wxIFMSlabAllocator *GetDataSlabs()
+{
+    static wxIFMSlabAllocator slabs[IFM_DATA_SLAB_CLASSES];
+    static bool init = false;
+
+    if( !init )
+    {
+        for( int i = 0; i < IFM_DATA_SLAB_CLASSES; ++i )
+            slabs[i].SetBlockSize((i + 1) * IFM_SLAB_ALIGN);
+        init = true;
+    }
+
+    return slabs;
+}
+#endif
 
 wxIFMComponentDataKeyType GetNewDataKey()
 {
@@ -58,6 +103,10 @@ int GetNewChildType()
 /*
 wxInterfaceManager implementation
 */
+BEGIN_EVENT_TABLE(wxInterfaceManager, wxEvtHandler)
+    EVT_IDLE        (wxInterfaceManager::OnIdle)
+END_EVENT_TABLE()
+
 wxInterfaceManager::wxInterfaceManager(wxWindow *parent, wxWindow *content)
     : m_initialized(false),
     m_flags(IFM_DEFAULT_FLAGS),
@@ -169,6 +218,12 @@ void wxInterfaceManager::Shutdown()
 
     RemoveAllInterfacePlugins();
     m_parent->RemoveEventHandler(this);
+
+    while( m_damage.GetCount() )
+        DiscardDamage(m_damage[0].m_window);
+
+    // all of our components are gone now
+    wxIFMComponent::ReleaseUnusedMemory();
 }
 
 bool wxInterfaceManager::AddChild(wxIFMChildDataBase *data, bool update)
@@ -194,6 +249,60 @@ bool wxInterfaceManager::AddChild(wxIFMChildDataBase *data, bool update)
     return true;
 }
 
+wxString wxInterfaceManager::SaveLayout()
+{
+    wxASSERT_MSG(m_initialized, wxT("Interface not initialized"));
+
+    wxIFMLayoutEvent event(wxEVT_IFM_SAVELAYOUT);
+    GetActiveIP()->ProcessPluginEvent(event);
+    if( !event.GetSuccess() )
+        return wxEmptyString;
+
+    return event.GetLayout();
+}
+
+bool wxInterfaceManager::LoadLayout(const wxString &layout, bool update)
+{
+    wxASSERT_MSG(m_initialized, wxT("Interface not initialized"));
+
+    wxIFMLayoutEvent event(wxEVT_IFM_LOADLAYOUT, layout);
+    GetActiveIP()->ProcessPluginEvent(event);
+    if( !event.GetSuccess() )
+        return false;
+
+    // the layout is built without updating, do it once now
+    if( update )
+        Update();
+
+    return true;
+}
+
+bool wxInterfaceManager::AddChildren(const wxIFMChildDataArray &children, bool update)
+{
+    wxASSERT_MSG(m_initialized, wxT("Interface not initialized"));
+
+    bool success = true;
+
+    wxIFMAddChildrenEvent event(children);
+    if( GetActiveIP()->ProcessPluginEvent(event) )
+        success = event.GetAddedCount() == (int)children.GetCount();
+    else
+    {
+        // the interface can't add children in bulk, add them one by one
+        for( size_t i = 0; i < children.GetCount(); ++i )
+        {
+            if( !AddChild(children[i], false) )
+                success = false;
+        }
+    }
+
+    // update interface?
+    if( update )
+        Update();
+
+    return success;
+}
+
 void wxInterfaceManager::ShowChild(wxWindow *child, bool show, bool update)
 {
     // send showchild event
@@ -439,6 +548,94 @@ void wxInterfaceManager::ResetStatusMessage()
     }
 }
 
+void wxInterfaceManager::AddDamage(wxWindow *window, const wxRect &rect)
+{
+    wxASSERT_MSG(window, wxT("Damaging a NULL window?"));
+    if( !window || rect.IsEmpty() )
+        return;
+
+    bool known = false;
+
+    for( size_t i = 0; i < m_damage.GetCount(); i++ )
+    {
+        wxIFMDamage &damage = m_damage[i];
+        if( damage.m_window != window )
+            continue;
+
+        known = true;
+
+        // merge touching areas so each one is only refreshed once
+        wxRect grown = damage.m_rect;
+        grown.Inflate(1, 1);
+        if( grown.Intersects(rect) )
+        {
+            damage.m_rect.Union(rect);
+            return;
+        }
+    }
+
+    // make sure damage is forgotten if the window goes away before it is flushed
+    if( !known )
+        window->Connect(wxEVT_DESTROY, wxWindowDestroyEventHandler(wxInterfaceManager::OnDamagedWindowDestroy), NULL, this);
+
+    m_damage.Add(wxIFMDamage(window, rect));
+}
+
+void wxInterfaceManager::FlushDamage()
+{
+    while( m_damage.GetCount() )
+    {
+        wxWindow *window = m_damage[0].m_window;
+
+        for( size_t i = 0; i < m_damage.GetCount(); i++ )
+        {
+            if( m_damage[i].m_window == window )
+                window->RefreshRect(m_damage[i].m_rect);
+        }
+
+        DiscardDamage(window);
+    }
+}
+
+void wxInterfaceManager::DiscardDamage(wxWindow *window)
+{
+    if( RemoveDamage(window) )
+        window->Disconnect(wxEVT_DESTROY, wxWindowDestroyEventHandler(wxInterfaceManager::OnDamagedWindowDestroy), NULL, this);
+}
+
+bool wxInterfaceManager::RemoveDamage(wxWindow *window)
+{
+    bool found = false;
+
+    for( size_t i = m_damage.GetCount(); i > 0; i-- )
+    {
+        if( m_damage[i - 1].m_window == window )
+        {
+            m_damage.RemoveAt(i - 1);
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+void wxInterfaceManager::OnIdle(wxIdleEvent &event)
+{
+    FlushDamage();
+    event.Skip();
+}
+
+void wxInterfaceManager::OnDamagedWindowDestroy(wxWindowDestroyEvent &event)
+{
+    // the handler is connected to each damaged window, so the event object is the window
+    // going away. The handler is not disconnected here, it is destroyed along with the window
+    wxWindow *window = wxDynamicCast(event.GetEventObject(), wxWindow);
+    if( window )
+        RemoveDamage(window);
+
+    event.Skip();
+}
+
 #if IFM_CANFLOAT
 
 /*
@@ -462,20 +659,25 @@ wxIFMFloatingWindowBase::wxIFMFloatingWindowBase(wxIFMInterfacePluginBase *ip, w
         wxWindowID id, const wxPoint& pos, const wxSize& size, long style, const wxString& name)
     : m_ip(ip),
     m_component(NULL),
-    m_destroyRoot(true)
+    m_destroyRoot(true),
+    m_displayListDirty(true)
 {
     m_window = new wxWindow(parent, id, pos, size, style, name);
     ConnectEvents();
 }
 
 wxIFMFloatingWindowBase::wxIFMFloatingWindowBase(wxIFMInterfacePluginBase *ip)
-    : m_ip(ip)
+    : m_ip(ip),
+    m_displayListDirty(true)
 { }
 
 wxIFMFloatingWindowBase::~wxIFMFloatingWindowBase()
 {
-    DisconnectEvents();
-    m_window->Destroy();
+    if( m_window )
+    {
+        DisconnectEvents();
+        m_window->Destroy();
+    }
 
     // delete our root container
     if( m_destroyRoot )
@@ -505,6 +707,19 @@ wxIFMComponent *wxIFMFloatingWindowBase::GetComponent() const
     return m_component;
 }
 
+wxWindow *wxIFMFloatingWindowBase::DetachWindow()
+{
+    wxWindow *window = m_window;
+
+    if( window )
+    {
+        DisconnectEvents();
+        m_window = NULL;
+    }
+
+    return window;
+}
+
 void wxIFMFloatingWindowBase::ConnectEvents()
 {
     m_window->PushEventHandler(this);
@@ -536,13 +751,33 @@ void wxIFMFloatingWindowBase::OnMoving(wxMoveEvent &event)
 void wxIFMFloatingWindowBase::OnPaint(wxPaintEvent &WXUNUSED(event))
 {
     // send BEGINPAINT message to get a DC with which to paint
-    wxIFMBeginPaintEvent beginpaint(m_window);
+    wxIFMBeginPaintEvent beginpaint(m_window, true, &m_backBuffer);
     GetIP()->ProcessPluginEvent(beginpaint);
 
     wxDC *dc = beginpaint.GetDC();
     wxASSERT_MSG(dc, wxT("Invalid DC returned by EVT_IFM_BEGINPAINT"));
 
-    m_component->Paint(*dc, m_window->GetUpdateRegion());
+    if( GetManager()->GetFlags() & IFM_DISPLAY_LIST )
+    {
+        // record the window contents once per layout and replay them for each expose
+        if( m_displayListDirty )
+        {
+            m_displayList.Clear();
+            m_component->BuildDisplayList(m_displayList);
+            m_displayListDirty = false;
+        }
+
+        m_displayList.Replay(*dc, m_window->GetUpdateRegion());
+    }
+    else
+    {
+        // clip once for the whole window, components don't clip individually
+        const wxRegion &region = m_window->GetUpdateRegion();
+        dc->DestroyClippingRegion();
+        dc->SetClippingRegion(region);
+
+        m_component->Paint(*dc, region);
+    }
 
     // send ENDPAINT message to clean up the DC used to paint
     wxIFMEndPaintEvent endpaint(dc);
@@ -656,12 +891,35 @@ void wxIFMFloatingWindowBase::AddPendingUpdate()
 
 #endif
 
+/*
+wxIFMComponentHandle implementation
+*/
+wxIFMComponent *wxIFMComponentHandle::Get() const
+{
+    if( m_generation == 0 )
+        return NULL;
+
+    wxIFMComponentStore &store = GetComponentStore();
+    if( m_index >= store.m_components.GetCount() ||
+        (unsigned int)store.m_generations[m_index] != m_generation )
+        return NULL;
+
+    return (wxIFMComponent *)store.m_components[m_index];
+}
+
 /*
 wxIFMComponent implementation
 */
 wxIFMComponent::wxIFMComponent(wxIFMInterfacePluginBase *ip, int type)
     : m_type(type),
     m_ip(ip),
+    m_boundsDirty(true),
+    m_treeEnter(0),
+    m_treeExit(0),
+    m_treeRoot(NULL),
+    m_treeGeneration(0),
+    m_visibleChildren(0),
+    m_visibleLeaves(0),
     m_minSize(IFM_NO_MINIMUM_SIZE),
     m_maxSize(IFM_NO_MAXIMUM_SIZE),
     m_fixed(false),
@@ -674,10 +932,29 @@ wxIFMComponent::wxIFMComponent(wxIFMInterfacePluginBase *ip, int type)
     m_childType(IFM_CHILDTYPE_UNDEFINED),
     m_child(NULL)
 {
+    for( int i = 0; i < IFM_COMPONENT_DATA_SLOTS; ++i )
+        m_slots[i] = NULL;
+
+    // take a slot in the component store
+    wxIFMComponentStore &store = GetComponentStore();
+    unsigned int index;
+    if( store.m_free.GetCount() )
+    {
+        index = store.m_free.Last();
+        store.m_free.RemoveAt(store.m_free.GetCount() - 1);
+        store.m_components[index] = this;
+    }
+    else
+    {
+        index = store.m_components.GetCount();
+        store.m_components.Add(this);
+        store.m_generations.Add(1);
+    }
+    m_handle = wxIFMComponentHandle(index, store.m_generations[index]);
+
 #if IFM_CANFLOAT
     // create floating data data
-    wxIFMExtensionDataBase *data = new wxIFMFloatingData;
-    m_data[data->GetDataKey()] = data;
+    AddExtensionData(new wxIFMFloatingData);
 #endif
 }
 
@@ -686,11 +963,80 @@ wxIFMComponent::wxIFMComponent(const wxIFMComponent &)
 
 wxIFMComponent::~wxIFMComponent()
 {
+    // another component may be allocated at this address later
+    InvalidateTreeLabels();
+
+    // release our slot, handles to this component no longer resolve
+    if( m_handle.m_generation )
+    {
+        wxIFMComponentStore &store = GetComponentStore();
+        unsigned int index = m_handle.m_index;
+        store.m_components[index] = NULL;
+        // generation 0 is reserved for null handles
+        int &generation = store.m_generations[index];
+        generation = generation == INT_MAX ? 1 : generation + 1;
+        store.m_free.Add(index);
+    }
+
     // clean up data
+    for( int i = 0; i < IFM_COMPONENT_DATA_SLOTS; ++i )
+        delete m_slots[i];
     for( wxIFMComponentDataMap::iterator i = m_data.begin(), end = m_data.end(); i != end; ++i )
         delete i->second;
 }
 
+#if IFM_USE_COMPONENT_SLABS
+void *wxIFMComponent::operator new(size_t size)
+{
+    if( size == sizeof(wxIFMComponent) )
+        return GetComponentSlab().Alloc();
+    else
+        return ::operator new(size);
+}
+
+void wxIFMComponent::operator delete(void *block, size_t size)
+{
+    if( !block )
+        return;
+
+    if( size == sizeof(wxIFMComponent) )
+        GetComponentSlab().Free(block);
+    else
+        ::operator delete(block);
+}
+#endif
+
+void wxIFMComponent::ReserveComponents(size_t count)
+{
+    wxIFMComponentStore &store = GetComponentStore();
+    if( count > store.m_free.GetCount() )
+    {
+        size_t needed = store.m_components.GetCount() + count - store.m_free.GetCount();
+        store.m_components.Alloc(needed);
+        store.m_generations.Alloc(needed);
+    }
+
+#if IFM_USE_COMPONENT_SLABS
+    GetComponentSlab().Reserve(count);
+#endif
+}
+
+void wxIFMComponent::ReleaseUnusedMemory()
+{
+#if IFM_USE_COMPONENT_SLABS
+    GetComponentSlab().Purge();
+
+    wxIFMSlabAllocator *slabs = GetDataSlabs();
+    for( int i = 0; i < IFM_DATA_SLAB_CLASSES; ++i )
+        slabs[i].Purge();
+#endif
+}
+
+wxIFMComponentHandle wxIFMComponent::GetHandle() const
+{
+    return m_handle;
+}
+
 wxInterfaceManager *wxIFMComponent::GetManager()
 {
     return m_ip->GetManager();
@@ -703,18 +1049,43 @@ int wxIFMComponent::GetType() const
 
 void wxIFMComponent::AddExtensionData(wxIFMExtensionDataBase *data)
 {
-    m_data[data->GetDataKey()] = data;
+    wxIFMComponentDataKeyType key = data->GetDataKey();
+
+    if( key >= 0 && key < IFM_COMPONENT_DATA_SLOTS )
+        m_slots[key] = data;
+    else
+        m_data[key] = data;
 }
 
 wxIFMExtensionDataBase *wxIFMComponent::GetExtensionData(wxIFMComponentDataKeyType key)
 {
-    return m_data[key];
+    if( key >= 0 && key < IFM_COMPONENT_DATA_SLOTS )
+        return m_slots[key];
+
+    // keys handed out after the slots ran out
+    wxIFMComponentDataMap::iterator i = m_data.find(key);
+    if( i == m_data.end() )
+        return NULL;
+    return i->second;
 }
 
 wxIFMExtensionDataBase *wxIFMComponent::RemoveExtensionData(wxIFMComponentDataKeyType key)
 {
-    wxIFMExtensionDataBase *ret = m_data[key];
-    m_data.erase(key);
+    wxIFMExtensionDataBase *ret;
+
+    if( key >= 0 && key < IFM_COMPONENT_DATA_SLOTS )
+    {
+        ret = m_slots[key];
+        m_slots[key] = NULL;
+        return ret;
+    }
+
+    wxIFMComponentDataMap::iterator i = m_data.find(key);
+    if( i == m_data.end() )
+        return NULL;
+
+    ret = i->second;
+    m_data.erase(i);
     return ret;
 }
 
@@ -730,27 +1101,46 @@ int wxIFMComponent::GetNextVisibleComponent(const wxIFMComponentArray &component
     return -1;
 }
 
+unsigned long wxIFMComponent::ms_treeGeneration = 1;
+
 bool wxIFMComponent::IsChildOf(wxIFMComponent *parent, wxIFMComponent *child)
 {
-    wxIFMComponentArray &children = parent->m_children;
-    wxIFMComponent *component;
-    for( int i = 0, size = children.GetCount(); i < size; ++i )
-    //for( wxIFMComponentArray::const_iterator i = children.begin(), end = children.end(); i != end; ++i )
+    if( !parent || !child || parent == child )
+        return false;
+
+    // label the whole tree containing parent if the tree changed since it was last labeled
+    if( parent->m_treeGeneration != ms_treeGeneration )
     {
-        component = children[i];
-        //component = *i;
+        wxIFMComponent *root = parent;
+        while( root->m_parent )
+            root = root->m_parent;
 
-        if( component == child )
-            return true;
-        else
-        {
-            // look through children of the child too
-            if( wxIFMComponent::IsChildOf(component, child) )
-                return true;
-        }
+        int counter = 0;
+        root->LabelTree(root, counter);
     }
 
-    return false;
+    // child was labeled along with parent if it is in the same tree
+    if( child->m_treeGeneration != ms_treeGeneration || child->m_treeRoot != parent->m_treeRoot )
+        return false;
+
+    return parent->m_treeEnter < child->m_treeEnter && child->m_treeExit < parent->m_treeExit;
+}
+
+void wxIFMComponent::InvalidateTreeLabels()
+{
+    ms_treeGeneration++;
+}
+
+void wxIFMComponent::LabelTree(wxIFMComponent *root, int &counter)
+{
+    m_treeRoot = root;
+    m_treeGeneration = ms_treeGeneration;
+    m_treeEnter = counter++;
+
+    for( size_t i = 0, count = m_children.GetCount(); i < count; ++i )
+        m_children[i]->LabelTree(root, counter);
+
+    m_treeExit = counter++;
 }
 
 /*
@@ -776,13 +1166,6 @@ wxIFMComponent *wxIFMComponent::FindChildWindow(wxWindow *child, const wxIFMComp
 
 void wxIFMComponent::Paint(wxDC &dc, const wxRegion &region)
 {
-    // get component rect first
-    wxRect rect = m_rect;
-
-    // set clipping region of DC
-    dc.DestroyClippingRegion();
-    dc.SetClippingRegion(region);
-
     // paint background first
     wxIFMPaintEvent bgevt(wxEVT_IFM_PAINTBG, this, region, dc);
     m_ip->ProcessPluginEvent(bgevt);
@@ -805,17 +1188,70 @@ void wxIFMComponent::Paint(wxDC &dc, const wxRegion &region)
         // only paint the child if needed
         if( child->IsVisible() )
         {
-            wxRegionContain result = region.Contains(child->m_rect);
-            if( result == wxPartRegion || result == wxInRegion )
+            const wxRect &bounds = child->GetBounds();
+            wxRegionContain result = region.Contains(bounds);
+            if( result == wxInRegion )
+                child->Paint(dc, wxRegion(bounds));
+            else if( result == wxPartRegion )
             {
-                //wxRegion new_region = region;
-                //new_region.Intersect(child->m_rect);
-                child->Paint(dc, region);
+                wxRegion new_region = region;
+                new_region.Intersect(bounds);
+                child->Paint(dc, new_region);
             }
         }
     }
 }
 
+const wxRect &wxIFMComponent::GetBounds()
+{
+    if( m_boundsDirty )
+    {
+        m_bounds = m_rect;
+
+        // bring every child up to date, even hidden ones, so that none are left dirty
+        for( size_t i = 0; i < m_children.GetCount(); i++ )
+        {
+            wxIFMComponent *child = m_children[i];
+            const wxRect &bounds = child->GetBounds();
+            if( child->IsVisible() )
+                m_bounds.Union(bounds);
+        }
+
+        m_boundsDirty = false;
+    }
+
+    return m_bounds;
+}
+
+void wxIFMComponent::InvalidateBounds()
+{
+    // the parents of a dirty component are always dirty, so stop at the first one
+    for( wxIFMComponent *component = this; component && !component->m_boundsDirty; component = component->m_parent )
+        component->m_boundsDirty = true;
+}
+
+void wxIFMComponent::BuildDisplayList(wxIFMDisplayList &list)
+{
+    // record background first, then border, then decorations
+    wxIFMDisplayListEvent bgevt(this, list, IFM_DISPLAY_BACKGROUND);
+    m_ip->ProcessPluginEvent(bgevt);
+
+    wxIFMDisplayListEvent bdevt(this, list, IFM_DISPLAY_BORDER);
+    m_ip->ProcessPluginEvent(bdevt);
+
+    wxIFMDisplayListEvent dcevt(this, list, IFM_DISPLAY_DECORATIONS);
+    m_ip->ProcessPluginEvent(dcevt);
+
+    // recursively record visible children of this component
+    for( size_t i = 0; i < m_children.GetCount(); i++ )
+    {
+        wxIFMComponent *child = m_children[i];
+
+        if( child->IsVisible() )
+            child->BuildDisplayList(list);
+    }
+}
+
 wxWindow *wxIFMComponent::GetParentWindow()
 {
 #if IFM_CANFLOAT
@@ -885,7 +1321,11 @@ void wxIFMComponent::Show(bool s, bool update)
 {
     wxIFMShowComponentEvent evt(this, s, update);
     m_ip->ProcessPluginEvent(evt);
+
+    bool was_visible = IsVisible();
+    int old_contribution = GetVisibleContribution();
     m_hidden = !s;
+    VisibilityUpdated(was_visible, old_contribution);
 }
 
 bool wxIFMComponent::IsShown()
@@ -900,7 +1340,14 @@ void wxIFMComponent::VisibilityChanged(bool vis)
 
     wxIFMComponentVisibilityChangedEvent evt(this, vis);
     m_ip->ProcessPluginEvent(evt);
+
+    // children have already updated our counts while the event was processed
+    bool was_visible = IsVisible();
+    int old_contribution = GetVisibleContribution();
     m_visible = vis;
+    VisibilityUpdated(was_visible, old_contribution);
+
+    InvalidateBounds();
 }
 
 bool wxIFMComponent::IsVisible()
@@ -908,6 +1355,62 @@ bool wxIFMComponent::IsVisible()
     return (!m_hidden) & m_visible;
 }
 
+int wxIFMComponent::GetVisibleContribution()
+{
+    if( m_type == IFM_COMPONENT_CONTAINER )
+        return m_visibleLeaves;
+    else
+        return IsVisible() ? 1 : 0;
+}
+
+void wxIFMComponent::AdjustVisibleCounts(int children, int leaves)
+{
+    m_visibleChildren += children;
+
+    for( wxIFMComponent *component = this; component && leaves != 0; component = component->m_parent )
+    {
+        component->m_visibleLeaves += leaves;
+
+        // only containers pass the leaves of their children on
+        if( component->m_type != IFM_COMPONENT_CONTAINER )
+            break;
+    }
+}
+
+void wxIFMComponent::VisibilityUpdated(bool was_visible, int old_contribution)
+{
+    if( !m_parent )
+        return;
+
+    int children = (IsVisible() ? 1 : 0) - (was_visible ? 1 : 0);
+    m_parent->AdjustVisibleCounts(children, GetVisibleContribution() - old_contribution);
+}
+
+void wxIFMComponent::ChildrenChanged(wxIFMComponent *child, bool added)
+{
+    int children = child->IsVisible() ? 1 : 0;
+    int leaves = child->GetVisibleContribution();
+
+    if( added )
+        AdjustVisibleCounts(children, leaves);
+    else
+        AdjustVisibleCounts(-children, -leaves);
+
+    // our bounds change with our children, this also keeps the parents of a
+    // dirty child dirty when it is docked
+    InvalidateBounds();
+}
+
+int wxIFMComponent::GetVisibleChildCount() const
+{
+    return m_visibleChildren;
+}
+
+int wxIFMComponent::GetVisibleLeafCount() const
+{
+    return m_visibleLeaves;
+}
+
 /*
     wxIFMChildDataBase implementation
 */
@@ -949,12 +1452,281 @@ wxIFMChildDataBase::wxIFMChildDataBase(const wxIFMChildDataBase &data)
 wxIFMChildDataBase::~wxIFMChildDataBase()
 { }
 
+/*
+    wxIFMDisplayList implementation
+*/
+wxIFMDisplayItem &wxIFMDisplayList::AddItem(int type, const wxRect &bounds)
+{
+    m_items.Add(wxIFMDisplayItem());
+
+    wxIFMDisplayItem &item = m_items.Last();
+    item.m_type = type;
+    item.m_bounds = bounds;
+    item.m_param = 0;
+    return item;
+}
+
+void wxIFMDisplayList::Clear()
+{
+    m_items.Clear();
+}
+
+void wxIFMDisplayList::AddRectangle(const wxRect &rect, const wxPen &pen, const wxBrush &brush, int radius)
+{
+    wxIFMDisplayItem &item = AddItem(IFM_DRAW_RECT, rect);
+    item.m_rect = rect;
+    item.m_pen = pen;
+    item.m_brush = brush;
+    item.m_param = radius;
+}
+
+void wxIFMDisplayList::AddLine(int x1, int y1, int x2, int y2, const wxPen &pen)
+{
+    // bounds include the end point and the width of the pen
+    wxRect bounds(wxMin(x1, x2), wxMin(y1, y2), abs(x2 - x1) + 1, abs(y2 - y1) + 1);
+    bounds.Inflate(pen.GetWidth());
+
+    wxIFMDisplayItem &item = AddItem(IFM_DRAW_LINE, bounds);
+    item.m_pt1 = wxPoint(x1, y1);
+    item.m_pt2 = wxPoint(x2, y2);
+    item.m_pen = pen;
+}
+
+void wxIFMDisplayList::AddText(const wxString &text, int x, int y, const wxFont &font, const wxColour &colour, const wxRect &bounds)
+{
+    wxIFMDisplayItem &item = AddItem(IFM_DRAW_TEXT, bounds);
+    item.m_pt1 = wxPoint(x, y);
+    item.m_text = text;
+    item.m_font = font;
+    item.m_colour1 = colour;
+}
+
+void wxIFMDisplayList::AddBitmap(const wxBitmap &bitmap, int x, int y, bool transparent)
+{
+    wxIFMDisplayItem &item = AddItem(IFM_DRAW_BITMAP, wxRect(x, y, bitmap.GetWidth(), bitmap.GetHeight()));
+    item.m_pt1 = wxPoint(x, y);
+    item.m_bitmap = bitmap;
+    item.m_param = transparent;
+}
+
+void wxIFMDisplayList::AddGradient(const wxRect &rect, const wxColour &start, const wxColour &end, int direction)
+{
+    wxIFMDisplayItem &item = AddItem(IFM_DRAW_GRADIENT, rect);
+    item.m_rect = rect;
+    item.m_colour1 = start;
+    item.m_colour2 = end;
+    item.m_param = direction;
+}
+
+void wxIFMDisplayList::Replay(wxDC &dc, const wxRegion &region) const
+{
+    // clip once for the whole list instead of once per component
+    dc.DestroyClippingRegion();
+    dc.SetClippingRegion(region);
+
+    wxRegionContain result;
+    for( size_t i = 0, count = m_items.GetCount(); i < count; ++i )
+    {
+        const wxIFMDisplayItem &item = m_items[i];
+
+        // skip primitives outside of the update region
+        result = region.Contains(item.m_bounds);
+        if( !(result == wxInRegion || result == wxPartRegion) )
+            continue;
+
+        switch( item.m_type )
+        {
+        case IFM_DRAW_RECT:
+            dc.SetPen(item.m_pen);
+            dc.SetBrush(item.m_brush);
+            if( item.m_param )
+                dc.DrawRoundedRectangle(item.m_rect.x, item.m_rect.y, item.m_rect.width, item.m_rect.height, item.m_param);
+            else
+                dc.DrawRectangle(item.m_rect);
+            break;
+
+        case IFM_DRAW_LINE:
+            dc.SetPen(item.m_pen);
+            dc.DrawLine(item.m_pt1.x, item.m_pt1.y, item.m_pt2.x, item.m_pt2.y);
+            break;
+
+        case IFM_DRAW_TEXT:
+            dc.SetFont(item.m_font);
+            dc.SetTextForeground(item.m_colour1);
+            dc.DrawText(item.m_text, item.m_pt1.x, item.m_pt1.y);
+            break;
+
+        case IFM_DRAW_BITMAP:
+            dc.DrawBitmap(item.m_bitmap, item.m_pt1.x, item.m_pt1.y, item.m_param != 0);
+            break;
+
+        case IFM_DRAW_GRADIENT:
+            DrawGradient(dc, item.m_rect, item.m_colour1, item.m_colour2, item.m_param);
+            break;
+
+        default:
+            wxFAIL_MSG(wxT("Unknown display list primitive"));
+        }
+    }
+
+    dc.SetPen(wxNullPen);
+    dc.SetBrush(wxNullBrush);
+}
+
+void wxIFMDisplayList::DrawGradient(wxDC &dc, const wxRect &rect, const wxColour &start, const wxColour &end, int direction)
+{
+    if( rect.height < 1 || rect.width < 1 )
+        return;
+
+    dc.SetPen(*wxTRANSPARENT_PEN);
+
+    if( start == end )
+    {
+        dc.SetBrush(wxBrush(start, wxSOLID));
+        dc.DrawRectangle(rect);
+        return;
+    }
+
+    int size = (direction == wxVERTICAL) ? rect.height : rect.width;
+
+    // calculate gradient coefficients
+    double rstep = double(end.Red() - start.Red()) / double(size), rf = 0,
+        gstep = double(end.Green() - start.Green()) / double(size), gf = 0,
+        bstep = double(end.Blue() - start.Blue()) / double(size), bf = 0;
+
+    wxColour col;
+    for( int i = 0; i < size; i++ )
+    {
+        col.Set(
+            (unsigned char)(start.Red() + rf),
+            (unsigned char)(start.Green() + gf),
+            (unsigned char)(start.Blue() + bf)
+            );
+        dc.SetBrush(wxBrush(col, wxSOLID));
+
+        // draw one row or column of the gradient
+        if( direction == wxVERTICAL )
+            dc.DrawRectangle(rect.x, rect.y + i, rect.width, 1);
+        else
+            dc.DrawRectangle(rect.x + i, rect.y, 1, rect.height);
+
+        rf += rstep; gf += gstep; bf += bstep;
+    }
+}
+
 /*
     wxIFMExtensionDataBase implementation
 */
 wxIFMExtensionDataBase::~wxIFMExtensionDataBase()
 { }
 
+#if IFM_USE_COMPONENT_SLABS && !(defined(__WXDEBUG__) && wxUSE_MEMORY_TRACING)
+void *wxIFMExtensionDataBase::operator new(size_t size)
+{
+    size_t index = (size + IFM_SLAB_ALIGN - 1) / IFM_SLAB_ALIGN - 1;
+    if( index < IFM_DATA_SLAB_CLASSES )
+        return GetDataSlabs()[index].Alloc();
+    else
+        return ::operator new(size);
+}
+
+void wxIFMExtensionDataBase::operator delete(void *block, size_t size)
+{
+    if( !block )
+        return;
+
+    // size is the size of the most derived class thanks to the virtual destructor
+    size_t index = (size + IFM_SLAB_ALIGN - 1) / IFM_SLAB_ALIGN - 1;
+    if( index < IFM_DATA_SLAB_CLASSES )
+        GetDataSlabs()[index].Free(block);
+    else
+        ::operator delete(block);
+}
+#endif
+
+/*
+    wxIFMSlabAllocator implementation
+*/
+wxIFMSlabAllocator::wxIFMSlabAllocator(size_t blockSize)
+    : m_blockSize(0),
+    m_free(NULL),
+    m_used(0)
+{
+    SetBlockSize(blockSize);
+}
+
+wxIFMSlabAllocator::~wxIFMSlabAllocator()
+{
+    // blocks still in use would be left dangling, leak the slabs instead
+    Purge();
+}
+
+void wxIFMSlabAllocator::SetBlockSize(size_t blockSize)
+{
+    wxASSERT_MSG(m_slabs.GetCount() == 0, wxT("Changing the block size of a slab allocator in use"));
+    if( m_slabs.GetCount() != 0 )
+        return;
+
+    // blocks hold the free list link while unused
+    if( blockSize < sizeof(void *) )
+        blockSize = sizeof(void *);
+
+    m_blockSize = (blockSize + IFM_SLAB_ALIGN - 1) / IFM_SLAB_ALIGN * IFM_SLAB_ALIGN;
+}
+
+void wxIFMSlabAllocator::AddSlab()
+{
+    char *slab = (char *)::operator new(m_blockSize * IFM_SLAB_BLOCKS);
+    m_slabs.Add(slab);
+
+    // thread the new blocks onto the free list
+    for( int i = IFM_SLAB_BLOCKS - 1; i >= 0; --i )
+    {
+        void *block = slab + i * m_blockSize;
+        *(void **)block = m_free;
+        m_free = block;
+    }
+}
+
+void *wxIFMSlabAllocator::Alloc()
+{
+    if( !m_free )
+        AddSlab();
+
+    void *block = m_free;
+    m_free = *(void **)block;
+    m_used++;
+
+    return block;
+}
+
+void wxIFMSlabAllocator::Reserve(size_t count)
+{
+    while( m_slabs.GetCount() * IFM_SLAB_BLOCKS - m_used < count )
+        AddSlab();
+}
+
+void wxIFMSlabAllocator::Free(void *block)
+{
+    wxASSERT_MSG(m_used > 0, wxT("Freeing a block that was not allocated by this slab allocator"));
+
+    *(void **)block = m_free;
+    m_free = block;
+    m_used--;
+}
+
+void wxIFMSlabAllocator::Purge()
+{
+    if( m_used != 0 )
+        return;
+
+    for( size_t i = 0, count = m_slabs.GetCount(); i < count; ++i )
+        ::operator delete(m_slabs[i]);
+
+    m_slabs.Clear();
+    m_free = NULL;
+}
+
 wxIFMComponentDataKeyType wxIFMExtensionDataBase::DataKey()
 {
     return IFM_COMPONENT_UNDEFINED;
@@ -108,6 +108,11 @@ bool wxIFMInterfacePluginBase::ProcessPluginEvent(wxIFMPluginEvent &event)
         if( evt )
         {
             wxIFMComponent *component = evt->GetComponent();
+
+            // forget the child window if this component still owns it
+            if( component->m_child && FindChildWindow(component->m_child) == component )
+                RemoveChildWindow(component->m_child);
+
             // find and remove this component from the array
             //for( int i = 0, count = m_components.GetCount(); i < count; ++i )
             for( wxIFMComponentArray::iterator i = m_components.begin(), end = m_components.end(); i != end; ++i )
@@ -285,12 +290,17 @@ wxIFMComponent *wxIFMInterfacePluginBase::GetFloatingComponentByPos(const wxPoin
 void wxIFMInterfacePluginBase::AddChildWindow(wxWindow *window, wxIFMComponent *component)
 {
     // store the child window / component pair
-    m_windows[(int)window] = component;
+    m_windows.Insert(window, component);
+}
+
+void wxIFMInterfacePluginBase::RemoveChildWindow(wxWindow *window)
+{
+    m_windows.Remove(window);
 }
 
 wxIFMComponent *wxIFMInterfacePluginBase::FindChildWindow(wxWindow *window)
 {
-    return m_windows[(int)window];
+    return m_windows.Find(window);
 }
 
 void wxIFMInterfacePluginBase::OnMouseEvent(wxMouseEvent &event)
@@ -358,7 +368,7 @@ void wxIFMInterfacePluginBase::OnKeyUp(wxKeyEvent &event)
 void wxIFMInterfacePluginBase::OnPaint(wxPaintEvent &WXUNUSED(event))
 {
     // send BEGINPAINT message to get a DC with which to paint
-    wxIFMBeginPaintEvent beginpaint(m_manager->GetParent());
+    wxIFMBeginPaintEvent beginpaint(m_manager->GetParent(), true, &m_backBuffer);
     ProcessPluginEvent(beginpaint);
 
     // make sure we have a valid dc
@@ -398,6 +408,148 @@ void wxIFMInterfacePluginBase::OnActivate(wxActivateEvent &event)
         event.Skip();
 }
 
+/*
+wxIFMChildWindowMap implementation
+*/
+wxIFMChildWindowMap::wxIFMChildWindowMap()
+    : m_entries(NULL),
+    m_capacity(0),
+    m_count(0)
+{ }
+
+wxIFMChildWindowMap::~wxIFMChildWindowMap()
+{
+    delete [] m_entries;
+}
+
+size_t wxIFMChildWindowMap::GetSlot(const wxWindow *window) const
+{
+    // the low bits of a pointer are always zero, mix the rest down
+    wxUIntPtr h = (wxUIntPtr)window;
+    h ^= h >> 4;
+    h ^= h >> 12;
+    return (size_t)h & (m_capacity - 1);
+}
+
+void wxIFMChildWindowMap::Grow()
+{
+    Rehash(m_capacity ? m_capacity * 2 : IFM_CHILD_WINDOW_MAP_SIZE);
+}
+
+void wxIFMChildWindowMap::Reserve(size_t count)
+{
+    size_t capacity = m_capacity ? m_capacity : IFM_CHILD_WINDOW_MAP_SIZE;
+    while( (m_count + count) * 2 > capacity )
+        capacity *= 2;
+
+    if( capacity != m_capacity )
+        Rehash(capacity);
+}
+
+void wxIFMChildWindowMap::Rehash(size_t capacity)
+{
+    Entry *old = m_entries;
+    size_t old_capacity = m_capacity;
+
+    m_capacity = capacity;
+    m_entries = new Entry[m_capacity];
+    for( size_t i = 0; i < m_capacity; ++i )
+        m_entries[i].m_window = NULL;
+
+    m_count = 0;
+    for( size_t i = 0; i < old_capacity; ++i )
+    {
+        if( old[i].m_window )
+            Insert(old[i].m_window, old[i].m_component);
+    }
+
+    delete [] old;
+}
+
+void wxIFMChildWindowMap::Insert(wxWindow *window, wxIFMComponent *component)
+{
+    wxASSERT_MSG(window, wxT("Adding a NULL child window?"));
+    if( !window )
+        return;
+
+    // keep the table at most half full so probe sequences stay short
+    if( (m_count + 1) * 2 > m_capacity )
+        Grow();
+
+    size_t mask = m_capacity - 1;
+    for( size_t i = GetSlot(window); ; i = (i + 1) & mask )
+    {
+        if( m_entries[i].m_window == window )
+        {
+            m_entries[i].m_component = component;
+            return;
+        }
+        else if( !m_entries[i].m_window )
+        {
+            m_entries[i].m_window = window;
+            m_entries[i].m_component = component;
+            m_count++;
+            return;
+        }
+    }
+}
+
+wxIFMComponent *wxIFMChildWindowMap::Find(const wxWindow *window) const
+{
+    if( !m_count || !window )
+        return NULL;
+
+    size_t mask = m_capacity - 1;
+    for( size_t i = GetSlot(window); m_entries[i].m_window; i = (i + 1) & mask )
+    {
+        if( m_entries[i].m_window == window )
+            return m_entries[i].m_component;
+    }
+
+    return NULL;
+}
+
+bool wxIFMChildWindowMap::Remove(const wxWindow *window)
+{
+    if( !m_count || !window )
+        return false;
+
+    size_t mask = m_capacity - 1;
+    size_t i = GetSlot(window);
+    for( ; m_entries[i].m_window != window; i = (i + 1) & mask )
+    {
+        if( !m_entries[i].m_window )
+            return false;
+    }
+
+    m_entries[i].m_window = NULL;
+    m_count--;
+
+    // shift following entries back so no probe sequence is broken by the hole
+    for( size_t j = (i + 1) & mask; m_entries[j].m_window; j = (j + 1) & mask )
+    {
+        size_t home = GetSlot(m_entries[j].m_window);
+
+        // leave the entry if its home slot lies cyclically within (i, j]
+        bool stays = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if( stays )
+            continue;
+
+        m_entries[i] = m_entries[j];
+        m_entries[j].m_window = NULL;
+        i = j;
+    }
+
+    return true;
+}
+
+void wxIFMChildWindowMap::Clear()
+{
+    for( size_t i = 0; i < m_capacity; ++i )
+        m_entries[i].m_window = NULL;
+    m_count = 0;
+}
+
 /*
 wxIFMExtensionPluginBase implementation
 */
@@ -438,3 +590,83 @@ void wxIFMExtensionPluginBase::Disable()
 {
     Enable(false);
 }
+
+/*
+wxIFMMotionScheduler implementation
+*/
+BEGIN_EVENT_TABLE(wxIFMMotionScheduler, wxEvtHandler)
+    EVT_TIMER           (wxID_ANY, wxIFMMotionScheduler::OnTimer)
+END_EVENT_TABLE()
+
+wxIFMMotionScheduler::wxIFMMotionScheduler()
+    : wxEvtHandler(),
+    m_ip(NULL),
+    m_component(NULL),
+    m_pending(false),
+    m_dispatching(false)
+{
+    m_timer.SetOwner(this);
+}
+
+void wxIFMMotionScheduler::SetPlugin(wxIFMInterfacePluginBase *plugin)
+{
+    m_ip = plugin;
+}
+
+bool wxIFMMotionScheduler::Schedule(wxIFMMouseEvent &event)
+{
+    // motion we are redelivering ourselves is always processed
+    if( m_dispatching )
+        return true;
+
+    // keep the delay within one frame even if the clock misbehaves
+    long elapsed = m_sinceDispatch.Time();
+    if( elapsed < 0 )
+        elapsed = 0;
+
+    if( elapsed >= IFM_MOTION_FRAME_INTERVAL )
+    {
+        // this event is newer than anything pending
+        Cancel();
+        m_sinceDispatch.Start();
+        return true;
+    }
+
+    m_component = event.GetComponent();
+    m_event = event.GetMouseEvent();
+    m_pending = true;
+
+    if( !m_timer.IsRunning() )
+        m_timer.Start(IFM_MOTION_FRAME_INTERVAL - elapsed, wxTIMER_ONE_SHOT);
+
+    return false;
+}
+
+void wxIFMMotionScheduler::Flush()
+{
+    if( !m_pending )
+        return;
+
+    wxASSERT_MSG(m_ip, wxT("Motion scheduler has no interface plugin"));
+    if( !m_ip )
+        return;
+
+    Cancel();
+    m_sinceDispatch.Start();
+
+    m_dispatching = true;
+    wxIFMMouseEvent evt(wxEVT_IFM_MOTION, m_component, m_event);
+    m_ip->ProcessPluginEvent(evt);
+    m_dispatching = false;
+}
+
+void wxIFMMotionScheduler::Cancel()
+{
+    m_pending = false;
+    m_timer.Stop();
+}
+
+void wxIFMMotionScheduler::OnTimer(wxTimerEvent &WXUNUSED(event))
+{
+    Flush();
+}
@@ -39,6 +39,7 @@ BEGIN_EVENT_TABLE(wxIFMDefaultResizePlugin, wxEvtHandler)
     EVT_IFM_CONVERTRECT     (wxIFMDefaultResizePlugin::OnConvertRect)
     EVT_IFM_SHOWCOMPONENT   (wxIFMDefaultResizePlugin::OnShowComponent)
     EVT_IFM_PAINTDECOR      (wxIFMDefaultResizePlugin::OnPaintDecor)
+    EVT_IFM_BUILDDISPLAYLIST(wxIFMDefaultResizePlugin::OnBuildDisplayList)
     EVT_IFM_GETRESIZESASHRECT(wxIFMDefaultResizePlugin::OnGetRect)
     EVT_IFM_SETRECT         (wxIFMDefaultResizePlugin::OnSetRect)
     EVT_IFM_SETCURSOR       (wxIFMDefaultResizePlugin::OnSetCursor)
@@ -65,7 +66,11 @@ wxIFMDefaultResizePlugin::wxIFMDefaultResizePlugin()
     m_ip(NULL),
     m_resizing(false),
     m_invalidated(false),
-    m_oldPos(wxPoint(-1,-1))
+    m_oldPos(wxPoint(-1,-1)),
+    m_hint(NULL),
+    m_realtime(false),
+    m_resizeComponent(NULL),
+    m_liveNeighbour(NULL)
 { }
 
 bool wxIFMDefaultResizePlugin::Initialize(wxIFMInterfacePluginBase *plugin)
@@ -81,9 +86,22 @@ bool wxIFMDefaultResizePlugin::Initialize(wxIFMInterfacePluginBase *plugin)
         return false;
     }
 
+    m_motion.SetPlugin(plugin);
+
     return true;
 }
 
+void wxIFMDefaultResizePlugin::Shutdown()
+{
+    m_motion.Cancel();
+
+    if( m_hint )
+    {
+        m_hint->Destroy();
+        m_hint = NULL;
+    }
+}
+
 void wxIFMDefaultResizePlugin::OnCreateComponent(wxIFMNewComponentEvent &event)
 {
     // let the component be created first
@@ -105,6 +123,13 @@ void wxIFMDefaultResizePlugin::OnDock(wxIFMDockEvent &event)
     // let the component be docked first
     GetNextHandler()->ProcessEvent(event);
 
+    // recalculate all sashes on the next update instead
+    if( m_ip->InBulkUpdate() )
+    {
+        m_invalidated = true;
+        return;
+    }
+
     wxIFMComponent *dest = event.GetDestination();
     wxASSERT_MSG(dest, wxT("NULL destination?"));
     if( !dest )
@@ -127,6 +152,13 @@ void wxIFMDefaultResizePlugin::OnUndock(wxIFMUndockEvent &event)
     if( !component )
         return;
 
+    if( m_ip->InBulkUpdate() )
+    {
+        GetNextHandler()->ProcessEvent(event);
+        m_invalidated = true;
+        return;
+    }
+
     // I need to determine before hand how many children will remain after the undock command is processed
     // If no children are left the container _may_ be destroyed and the parent pointer will point to a freed
     // object
@@ -147,6 +179,12 @@ void wxIFMDefaultResizePlugin::OnAddTopContainer(wxIFMAddTopContainerEvent &even
 {
     GetNextHandler()->ProcessEvent(event);
 
+    if( m_ip->InBulkUpdate() )
+    {
+        m_invalidated = true;
+        return;
+    }
+
     wxIFMComponent *component = event.GetComponent();
     wxASSERT_MSG(component, wxT("NULL component?"));
     if( !component )
@@ -217,9 +255,23 @@ void wxIFMDefaultResizePlugin::OnUpdate(wxIFMUpdateEvent &event)
     {
         m_invalidated = false;
 
-        const wxIFMComponentList &containers = m_ip->GetTopContainerList();
-        for( unsigned int i = 0; i < containers.size(); ++i )
+        const wxIFMComponentArray &containers = m_ip->GetTopContainers();
+        for( unsigned int i = 0; i < containers.GetCount(); ++i )
             UpdateContainerResizeSashes(containers[i]);
+
+#if IFM_CANFLOAT
+        // bulk updates can also dock and undock components inside floating windows
+        const wxIFMFloatingWindowArray &windows = m_ip->GetFloatingWindows();
+        for( unsigned int i = 0; i < windows.GetCount(); ++i )
+        {
+            wxIFMComponent *root = windows[i]->m_component;
+            if( root )
+            {
+                wxIFMUpdateResizeSashEvent evt(root);
+                GetIP()->ProcessPluginEvent(evt);
+            }
+        }
+#endif
     }
 
     event.Skip();
@@ -276,42 +328,20 @@ void wxIFMDefaultResizePlugin::UpdateContainerResizeSashes(wxIFMComponent *conta
     UpdateResizeSashes(container);
 }
 
-void wxIFMDefaultResizePlugin::UpdateResizeSashes(wxIFMComponent *component)
+int wxIFMDefaultResizePlugin::UpdateResizeSashes(wxIFMComponent *component)
 {
-    wxIFMResizeData *resizedata;
+    wxIFMResizeData *resizedata = IFM_GET_EXTENSION_DATA(component, wxIFMResizeData);
 
     //! \todo Allow for top / left resize sashes on children here
     // this would mean that the first visible child doesn't have a sash
     // as compared to the last visible child having no sash with right / bottom
-    int next = 0, current = wxIFMComponent::GetNextVisibleComponent(component->m_children, 0);
-
-    // if there are no visible children, do not display a resize sash on the container
-    // never display a resize sash on a docked container
-    resizedata = IFM_GET_EXTENSION_DATA(component, wxIFMResizeData);
-
-#if IFM_CANFLOAT
-    wxIFMFloatingData *floating_data = IFM_GET_EXTENSION_DATA(component, wxIFMFloatingData);
-#endif
-
-    if( !HasResizeableChildren(component)
-#if IFM_CANFLOAT
-        || (floating_data->m_floating && !component->m_docked)
-#endif
-      )
-    {
-        resizedata->m_display = false;
-    }
-    else
-        resizedata->m_display = true;
+    int current = wxIFMComponent::GetNextVisibleComponent(component->m_children, 0);
 
     // containers with no visible children don't get resize sashes
-    if( component->GetType() == IFM_COMPONENT_CONTAINER )
+    if( component->GetType() == IFM_COMPONENT_CONTAINER && current == -1 )
     {
-        if( component->GetNextVisibleComponent(component->m_children, 0) == -1 )
-        {
-            resizedata->m_display = false;
-            return;
-        }
+        resizedata->m_display = false;
+        return 0;
     }
 
     // determine resize sash side
@@ -321,26 +351,60 @@ void wxIFMDefaultResizePlugin::UpdateResizeSashes(wxIFMComponent *component)
     else if( component->m_alignment == IFM_ALIGN_HORIZONTAL )
         side = IFM_ORIENTATION_RIGHT;
 
-    // iterate over visible children
-    while( current >= 0 )
+    // iterate over visible children, collecting what the old HasResizeableChildren and
+    // HasVisibleChildren walks found from the results of the recursive calls instead
+    int flags = 0;
+    wxIFMResizeData *previous = NULL;
+
+    for( ; current >= 0; current = wxIFMComponent::GetNextVisibleComponent(component->m_children, current + 1) )
     {
         wxIFMComponent *child = component->m_children[current];
-        next = wxIFMComponent::GetNextVisibleComponent(component->m_children, current + 1);
+        bool container = child->GetType() == IFM_COMPONENT_CONTAINER;
 
-        resizedata = IFM_GET_EXTENSION_DATA(child, wxIFMResizeData);
-        resizedata->m_side = side;
+        wxIFMResizeData *childdata = IFM_GET_EXTENSION_DATA(child, wxIFMResizeData);
+        childdata->m_side = side;
+        childdata->m_index = current;
 
         // update resize sashes for the child
-        UpdateResizeSashes(child);
+        int child_flags = UpdateResizeSashes(child);
+
+        // the recursive call set the visibility of the previous child's resize sash based on
+        // whether it has resizeable children. Now that we know if the child after it has
+        // anything visible we can validate that choice.
+        if( previous && !(child_flags & IFM_RESIZE_SUBTREE_VISIBLE) )
+            previous->m_display = false;
+        previous = childdata;
 
-        // the last function set the visibility for the resize sash based on whether it has
-        // resizeable children. Now we need to validate its choice taking into consideration
-        // this childs position within its parent.
-        if( next == -1 || !wxIFMDefaultContainerPlugin::HasVisibleChildren(component->m_children[next]))
-            resizedata->m_display = false;
+        if( !child->m_fixed && (!container || (child_flags & IFM_RESIZE_SUBTREE_RESIZEABLE)) )
+            flags |= IFM_RESIZE_SUBTREE_RESIZEABLE;
 
-        current = next;
+        // child containers alone don't count, but their children do
+        if( !container || (child_flags & IFM_RESIZE_SUBTREE_VISIBLE) )
+            flags |= IFM_RESIZE_SUBTREE_VISIBLE;
     }
+
+    // the last visible child never has a sash
+    if( previous )
+        previous->m_display = false;
+
+    // if there are no resizeable children, do not display a resize sash on the component
+    // never display a resize sash on the root of a floating window
+#if IFM_CANFLOAT
+    wxIFMFloatingData *floating_data = IFM_GET_EXTENSION_DATA(component, wxIFMFloatingData);
+#endif
+
+    if( !(flags & IFM_RESIZE_SUBTREE_RESIZEABLE)
+#if IFM_CANFLOAT
+        || (floating_data->m_floating && !component->m_docked)
+#endif
+      )
+    {
+        resizedata->m_display = false;
+    }
+    else
+        resizedata->m_display = true;
+
+    return flags;
 }
 
 void wxIFMDefaultResizePlugin::OnConvertRect(wxIFMConvertRectEvent &event)
@@ -463,6 +527,48 @@ void wxIFMDefaultResizePlugin::OnPaintDecor(wxIFMPaintEvent &event)
     event.Skip();
 }
 
+// record the resize sash, same as OnPaintDecor
+void wxIFMDefaultResizePlugin::OnBuildDisplayList(wxIFMDisplayListEvent &event)
+{
+    if( event.GetPhase() == IFM_DISPLAY_DECORATIONS )
+    {
+        wxIFMComponent *component = event.GetComponent();
+        wxIFMResizeData *data = IFM_GET_EXTENSION_DATA(component, wxIFMResizeData);
+
+        if( data->m_display && component->IsVisible() )
+        {
+            wxIFMRectEvent rectevt(wxEVT_IFM_GETRESIZESASHRECT, component);
+            GetIP()->ProcessPluginEvent(rectevt);
+            wxRect sash_rect = rectevt.GetRect();
+
+            wxIFMDisplayList &list = event.GetDisplayList();
+
+            wxColour color(wxSystemSettings::GetColour(wxSYS_COLOUR_BTNFACE));
+            list.AddRectangle(sash_rect, wxPen(color), wxBrush(color));
+
+#if IFM_RESIZE_SASH_BORDER
+            wxPen border_pen(wxSystemSettings::GetColour(wxSYS_COLOUR_BTNSHADOW));
+
+            switch(data->m_side)
+            {
+            case IFM_ORIENTATION_LEFT:
+            case IFM_ORIENTATION_RIGHT:
+                list.AddLine(sash_rect.x + sash_rect.width - 1, sash_rect.y, sash_rect.x + sash_rect.width - 1, sash_rect.y + sash_rect.height, border_pen);
+                list.AddLine(sash_rect.x, sash_rect.y, sash_rect.x, sash_rect.y + sash_rect.height, border_pen);
+                break;
+            case IFM_ORIENTATION_TOP:
+            case IFM_ORIENTATION_BOTTOM:
+                list.AddLine(sash_rect.x, sash_rect.y, sash_rect.x + sash_rect.width, sash_rect.y, border_pen);
+                list.AddLine(sash_rect.x, sash_rect.y + sash_rect.height - 1, sash_rect.x + sash_rect.width, sash_rect.y + sash_rect.height - 1, border_pen);
+                break;
+            }
+#endif
+        }
+    }
+
+    event.Skip();
+}
+
 void wxIFMDefaultResizePlugin::OnGetRect(wxIFMRectEvent &event)
 {
     if( event.GetEventType() != wxEVT_IFM_GETRESIZESASHRECT )
@@ -589,9 +695,10 @@ void wxIFMDefaultResizePlugin::OnLeftDown(wxIFMMouseEvent &event)
         GetManager()->CaptureInput(component);
         GetManager()->GetCapturedWindow()->SetFocus();
         m_resizing = true;
+        m_realtime = (GetManager()->GetFlags() & IFM_LIVE_RESIZE) != 0;
 
         wxIFMResizeEvent evt(wxEVT_IFM_BEGINRESIZE, component,
-            event.GetMouseEvent().GetPosition(), false);
+            event.GetMouseEvent().GetPosition(), m_realtime);
         GetIP()->ProcessPluginEvent(evt);
     }
 }
@@ -600,11 +707,14 @@ void wxIFMDefaultResizePlugin::OnLeftUp(wxIFMMouseEvent &event)
 {
     if( m_resizing  )
     {
+        // catch up with the pointer before ending the resize
+        m_motion.Flush();
+
         m_resizing = false;
         GetManager()->ReleaseInput();
 
         wxIFMResizeEvent evt(wxEVT_IFM_ENDRESIZE, event.GetComponent(),
-            event.GetMouseEvent().GetPosition(), false);
+            event.GetMouseEvent().GetPosition(), m_realtime);
         GetIP()->ProcessPluginEvent(evt);
     }
     else
@@ -615,8 +725,11 @@ void wxIFMDefaultResizePlugin::OnMouseMove(wxIFMMouseEvent &event)
 {
     if( m_resizing )
     {
+        if( !m_motion.Schedule(event) )
+            return;
+
         wxIFMResizeEvent evt(wxEVT_IFM_RESIZE, event.GetComponent(),
-            event.GetMouseEvent().GetPosition(), false);
+            event.GetMouseEvent().GetPosition(), m_realtime);
         GetIP()->ProcessPluginEvent(evt);
     }
     else
@@ -629,8 +742,10 @@ void wxIFMDefaultResizePlugin::OnKeyDown(wxIFMKeyEvent &event)
     {
         if( event.GetKeyEvent().GetKeyCode() == WXK_ESCAPE )
         {
+            m_motion.Cancel();
+
             wxIFMResizeEvent evt(wxEVT_IFM_ENDRESIZE, event.GetComponent(),
-                event.GetKeyEvent().GetPosition(), false, true);
+                event.GetKeyEvent().GetPosition(), m_realtime, true);
             if( GetIP()->ProcessPluginEvent(evt) )
             {
                 m_resizing = false;
@@ -640,16 +755,12 @@ void wxIFMDefaultResizePlugin::OnKeyDown(wxIFMKeyEvent &event)
     }
 }
 
-void wxIFMDefaultResizePlugin::PaintResizeHint(wxScreenDC &dc, const wxRect &rect)
+void wxIFMDefaultResizePlugin::ShowResizeHint(const wxRect &rect)
 {
-    dc.SetBrush(*wxGREY_BRUSH);
-    dc.SetPen(*wxGREY_PEN);
-
-    dc.SetLogicalFunction(wxXOR);
-    dc.DrawRectangle(rect);
+    if( !m_hint )
+        m_hint = new wxIFMHintWindow(GetManager()->GetParent());
 
-    dc.SetPen(wxNullPen);
-    dc.SetBrush(wxNullBrush);
+    m_hint->ShowHint(rect);
 }
 
 void wxIFMDefaultResizePlugin::OnResizeBegin(wxIFMResizeEvent &event)
@@ -683,67 +794,52 @@ void wxIFMDefaultResizePlugin::OnResizeBegin(wxIFMResizeEvent &event)
     m_oldPos = GetManager()->GetCapturedWindow()->ClientToScreen(pos);
     m_resizeRect = wxRect(m_oldPos, rectevt.GetSize());
 
-    if( !event.RealtimeUpdates() )
+    if( event.RealtimeUpdates() )
     {
-        wxScreenDC dc;
-        PaintResizeHint(dc, m_resizeRect);
+        m_resizeComponent = component;
+        m_liveNeighbour = GetResizeNeighbour(component);
+        m_liveOldSize = component->GetDesiredSize();
+        if( m_liveNeighbour )
+            m_liveOldNeighbourSize = m_liveNeighbour->GetDesiredSize();
     }
+    else
+        ShowResizeHint(m_resizeRect);
 }
 
 void wxIFMDefaultResizePlugin::OnResizeEnd(wxIFMResizeEvent &event)
 {
-    if( !event.RealtimeUpdates() )
-    {
-        // unpaint resize hint
-        wxScreenDC dc;
-        PaintResizeHint(dc, m_resizeRect);
-    }
+    wxIFMComponent *component = event.GetComponent();
 
-    if( !event.WasCanceled() )
+    if( event.RealtimeUpdates() )
     {
-        wxIFMComponent *component = event.GetComponent();
-
-        wxIFMResizeData *resize_data = IFM_GET_EXTENSION_DATA(component, wxIFMResizeData);
-
-        wxPoint pos = event.GetPosition();
-
-        if( m_orientation == IFM_ALIGN_HORIZONTAL )
-        {
-            pos.y -= m_offset;
-            pos.x = m_resizeRect.x;
-        }
-        else if( m_orientation == IFM_ALIGN_VERTICAL )
+        // the layout already follows the sash, undo everything if canceled
+        if( event.WasCanceled() )
         {
-            pos.x -= m_offset;
-            pos.y = m_resizeRect.y;
+            component->SetDesiredSize(m_liveOldSize);
+            if( m_liveNeighbour )
+                m_liveNeighbour->SetDesiredSize(m_liveOldNeighbourSize);
+            UpdateResizeParent(component);
         }
 
-        // accessing m_rect directly here is OK because we know the component cannot be hidden
-        wxRect rect = component->m_rect;
-        int new_width = 0, new_height = 0;
+        m_liveNeighbour = NULL;
+        return;
+    }
 
-        switch(resize_data->m_side)
+    if( m_hint )
+        m_hint->HideHint();
+
+    if( !event.WasCanceled() )
+    {
+        wxSize size = GetResizeSize(component, event.GetPosition());
+
+        // let the sibling on the other side of the sash absorb the change if there is one
+        wxIFMComponent *neighbour = GetResizeNeighbour(component);
+        if( neighbour )
         {
-            case IFM_ORIENTATION_BOTTOM:
-                new_width = rect.width;
-                new_height = pos.y - rect.y + IFM_RESIZE_SASH_SIZE;
-                break;
-            case IFM_ORIENTATION_TOP:
-                new_width = rect.width;
-                new_height = rect.y + rect.height - pos.y;
-                break;
-            case IFM_ORIENTATION_LEFT:
-                new_height = rect.height;
-                new_width = rect.x + rect.width - pos.x;
-                break;
-            case IFM_ORIENTATION_RIGHT:
-                new_height = rect.height;
-                new_width = pos.x - rect.x + IFM_RESIZE_SASH_SIZE;
-                break;
+            ResizeNeighbours(component, neighbour, size);
+            return;
         }
 
-        wxSize size(new_width, new_height);
-
         if( component->m_docked )
         {
             // set the desired size of the component and its siblings to make room
@@ -756,16 +852,63 @@ void wxIFMDefaultResizePlugin::OnResizeEnd(wxIFMResizeEvent &event)
             GetIP()->ProcessPluginEvent(setevt);
         }
 
-        // only update the parent container to save updating the entire interface if we can get away with it
-        wxIFMComponent *parent = component->m_parent;
-        if( parent )
-        {
-            wxIFMUpdateComponentEvent evt(parent, parent->GetRect());
-            GetIP()->ProcessPluginEvent(evt);
-        }
-        else
-            GetManager()->Update();
+        UpdateResizeParent(component);
+    }
+}
+
+wxSize wxIFMDefaultResizePlugin::GetResizeSize(wxIFMComponent *component, wxPoint pos)
+{
+    wxIFMResizeData *resize_data = IFM_GET_EXTENSION_DATA(component, wxIFMResizeData);
+
+    if( m_orientation == IFM_ALIGN_HORIZONTAL )
+    {
+        pos.y -= m_offset;
+        pos.x = m_resizeRect.x;
+    }
+    else if( m_orientation == IFM_ALIGN_VERTICAL )
+    {
+        pos.x -= m_offset;
+        pos.y = m_resizeRect.y;
+    }
+
+    // accessing m_rect directly here is OK because we know the component cannot be hidden
+    wxRect rect = component->m_rect;
+    int new_width = 0, new_height = 0;
+
+    switch(resize_data->m_side)
+    {
+        case IFM_ORIENTATION_BOTTOM:
+            new_width = rect.width;
+            new_height = pos.y - rect.y + IFM_RESIZE_SASH_SIZE;
+            break;
+        case IFM_ORIENTATION_TOP:
+            new_width = rect.width;
+            new_height = rect.y + rect.height - pos.y;
+            break;
+        case IFM_ORIENTATION_LEFT:
+            new_height = rect.height;
+            new_width = rect.x + rect.width - pos.x;
+            break;
+        case IFM_ORIENTATION_RIGHT:
+            new_height = rect.height;
+            new_width = pos.x - rect.x + IFM_RESIZE_SASH_SIZE;
+            break;
+    }
+
+    return wxSize(new_width, new_height);
+}
+
+void wxIFMDefaultResizePlugin::UpdateResizeParent(wxIFMComponent *component)
+{
+    // only update the parent container to save updating the entire interface if we can get away with it
+    wxIFMComponent *parent = component->m_parent;
+    if( parent )
+    {
+        wxIFMUpdateComponentEvent evt(parent, parent->GetRect());
+        GetIP()->ProcessPluginEvent(evt);
     }
+    else
+        GetManager()->Update();
 }
 
 void wxIFMDefaultResizePlugin::ResizeComponent(wxIFMComponent *component, wxSize size)
@@ -840,8 +983,155 @@ void wxIFMDefaultResizePlugin::ResizeComponent(wxIFMComponent *component, wxSize
     }
 }
 
+wxIFMComponent *wxIFMDefaultResizePlugin::GetResizeNeighbour(wxIFMComponent *component)
+{
+    wxIFMComponent *parent = component->m_parent;
+    if( !component->m_docked || !parent || parent->GetType() != IFM_COMPONENT_CONTAINER )
+        return NULL;
+
+    wxIFMResizeData *data = IFM_GET_EXTENSION_DATA(component, wxIFMResizeData);
+
+    // use the index remembered by UpdateResizeSashes, it is only stale if the sashes
+    // haven't been updated since the children changed
+    wxIFMComponentArray &children = parent->m_children;
+    int index = data->m_index;
+    if( index < 0 || index >= (int)children.GetCount() || children[index] != component )
+    {
+        index = children.Index(component);
+        if( index == wxNOT_FOUND )
+            return NULL;
+    }
+
+    // the sash sits between the component and the visible sibling on the same side,
+    // sashes across the container's alignment have no such sibling
+    bool horizontal = data->m_side == IFM_ORIENTATION_LEFT || data->m_side == IFM_ORIENTATION_RIGHT;
+    if( horizontal != (parent->m_alignment == IFM_ALIGN_HORIZONTAL) )
+        return NULL;
+
+    wxIFMComponent *neighbour = NULL;
+    if( data->m_side == IFM_ORIENTATION_RIGHT || data->m_side == IFM_ORIENTATION_BOTTOM )
+    {
+        index = wxIFMComponent::GetNextVisibleComponent(children, index + 1);
+        if( index != -1 )
+            neighbour = children[index];
+    }
+    else
+    {
+        for( --index; index >= 0; --index )
+        {
+            if( children[index]->IsVisible() )
+            {
+                neighbour = children[index];
+                break;
+            }
+        }
+    }
+
+    // fixed size neighbours (toolbars) can't give up space, let the whole container
+    // make room instead
+    if( neighbour && neighbour->m_fixed )
+        return NULL;
+
+    return neighbour;
+}
+
+void wxIFMDefaultResizePlugin::ResizeNeighbours(wxIFMComponent *component, wxIFMComponent *neighbour, wxSize size)
+{
+    wxIFMResizeData *data = IFM_GET_EXTENSION_DATA(component, wxIFMResizeData);
+    bool horizontal = data->m_side == IFM_ORIENTATION_LEFT || data->m_side == IFM_ORIENTATION_RIGHT;
+    bool after = data->m_side == IFM_ORIENTATION_RIGHT || data->m_side == IFM_ORIENTATION_BOTTOM;
+
+    // accessing m_rect directly here is OK because both components are visible
+    wxRect rect = component->m_rect, neighbour_rect = neighbour->m_rect;
+    wxSize min = component->GetMinSize(), neighbour_min = neighbour->GetMinSize();
+    wxSize max = component->GetMaxSize(), neighbour_max = neighbour->GetMaxSize();
+
+    int length = horizontal ? size.x : size.y;
+    int old_length = horizontal ? rect.width : rect.height;
+    int total = old_length + (horizontal ? neighbour_rect.width : neighbour_rect.height);
+
+    int min_length = horizontal ? min.x : min.y;
+    int neighbour_min_length = horizontal ? neighbour_min.x : neighbour_min.y;
+    if( min_length < IFM_RESIZE_SASH_SIZE )
+        min_length = IFM_RESIZE_SASH_SIZE;
+    if( neighbour_min_length < 0 )
+        neighbour_min_length = 0;
+
+    int max_length = horizontal ? max.x : max.y;
+    int neighbour_max_length = horizontal ? neighbour_max.x : neighbour_max.y;
+
+    // keep both components within their maximum sizes so that the pair still fills
+    // the same space, the minimum sizes win if the two conflict
+    if( max_length != IFM_NO_MAXIMUM && length > max_length )
+        length = max_length;
+    if( neighbour_max_length != IFM_NO_MAXIMUM && length < total - neighbour_max_length )
+        length = total - neighbour_max_length;
+    if( length > total - neighbour_min_length )
+        length = total - neighbour_min_length;
+    if( length < min_length )
+        length = min_length;
+
+    int delta = length - old_length;
+    if( delta == 0 )
+        return;
+
+    // the pair keeps its combined extent, so only the shared edge moves
+    if( horizontal )
+    {
+        rect.width += delta;
+        neighbour_rect.width -= delta;
+        if( after )
+            neighbour_rect.x += delta;
+        else
+            rect.x -= delta;
+    }
+    else
+    {
+        rect.height += delta;
+        neighbour_rect.height -= delta;
+        if( after )
+            neighbour_rect.y += delta;
+        else
+            rect.y -= delta;
+    }
+
+    // remember the sizes for the next full layout
+    component->SetDesiredSize(rect.GetSize());
+    neighbour->SetDesiredSize(neighbour_rect.GetSize());
+
+    wxIFMUpdateComponentEvent evt1(component, rect);
+    GetIP()->ProcessPluginEvent(evt1);
+
+    wxIFMUpdateComponentEvent evt2(neighbour, neighbour_rect);
+    GetIP()->ProcessPluginEvent(evt2);
+}
+
+void wxIFMDefaultResizePlugin::ApplyLiveResize(const wxPoint &pos)
+{
+    wxIFMComponent *component = m_resizeComponent;
+    wxSize size = GetResizeSize(component, pos);
+
+    if( m_liveNeighbour )
+        ResizeNeighbours(component, m_liveNeighbour, size);
+    else
+    {
+        component->SetDesiredSize(size);
+        UpdateResizeParent(component);
+    }
+
+    // repaint now so that one frame is drawn per scheduled motion event
+    component->GetParentWindow()->Update();
+}
+
 void wxIFMDefaultResizePlugin::OnResizing(wxIFMResizeEvent &event)
 {
+    if( event.RealtimeUpdates() )
+    {
+        // motion is already coalesced by m_motion, relayout right away
+        ApplyLiveResize(event.GetPosition());
+        return;
+    }
+
     wxPoint pos = GetManager()->GetCapturedWindow()->ClientToScreen(event.GetPosition());
 
     if( m_orientation == IFM_ALIGN_HORIZONTAL )
@@ -855,16 +1145,9 @@ void wxIFMDefaultResizePlugin::OnResizing(wxIFMResizeEvent &event)
         pos.y = m_resizeRect.y;
     }
 
-    if( !event.RealtimeUpdates() )
-    {
-        // draw resize sash
-        wxScreenDC dc;
-
-        m_resizeRect.SetPosition(m_oldPos);
-        PaintResizeHint(dc, m_resizeRect);
-        m_resizeRect.SetPosition(pos);
-        PaintResizeHint(dc, m_resizeRect);
-    }
+    // move resize sash
+    m_resizeRect.SetPosition(pos);
+    ShowResizeHint(m_resizeRect);
 
     m_oldPos = pos;
 }
@@ -905,7 +1188,8 @@ wxIFMResizeData implementation
 wxIFMResizeData::wxIFMResizeData()
     : wxIFMExtensionDataBase(),
     m_side(IFM_ORIENTATION_NONE),
-    m_display(false)
+    m_display(false),
+    m_index(-1)
 { }
 
 wxIFMComponentDataKeyType wxIFMResizeData::GetDataKey() const